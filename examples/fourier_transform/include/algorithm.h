@@ -9,6 +9,7 @@
 #ifndef EXAMPLES_FOURIER_TRANSFORM_INCLUDE_ALGORITHM_H_
 #define EXAMPLES_FOURIER_TRANSFORM_INCLUDE_ALGORITHM_H_
 
+#include <modcncy/barrier.h>
 #include <modcncy/wait_policy.h>
 
 #include <complex>
@@ -31,13 +32,15 @@ void FFT(std::complex<float>* data, size_t data_size,
          FftType fft_type = FftType::kSequentialOriginalFft,
          size_t num_threads = std::thread::hardware_concurrency(),
          size_t segment_size = 1 /*number of elements*/,
-         std::function<void()> wait_policy = &modcncy::cpu_yield) {
+         std::function<void()> wait_policy = &modcncy::cpu_yield,
+         modcncy::Barrier* barrier = nullptr) {
   switch (fft_type) {
     case FftType::kSequentialOriginalFft:
       fft::original(data, data_size);
       break;
     case FftType::kParallelBlockingFft:
-      fft::blocking(data, data_size, num_threads, segment_size, wait_policy);
+      fft::blocking(data, data_size, num_threads, segment_size, wait_policy,
+                    barrier);
       break;
     case FftType::kParallelLockFreeFft:
       fft::lockfree(data, data_size, num_threads, segment_size, wait_policy);
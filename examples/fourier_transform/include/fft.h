@@ -112,9 +112,11 @@ void original(std::complex<float>* data, size_t data_size) {
 
 // =============================================================================
 // Parallel pthreads segmented FFT.
+// Threads synchronize at `barrier` if given, or at their own barrier otherwise.
 void blocking(std::complex<float>* data, size_t data_size, size_t num_threads,
               size_t segment_size,
-              std::function<void()> wait_policy = &modcncy::cpu_yield) {
+              std::function<void()> wait_policy = &modcncy::cpu_yield,
+              modcncy::Barrier* barrier = nullptr) {
   // Setup.
   const size_t num_segments = data_size / segment_size;
 
@@ -154,8 +156,12 @@ void blocking(std::complex<float>* data, size_t data_size, size_t num_threads,
     }
   };  // function thread_work
 
-  modcncy::Barrier* barrier = modcncy::Barrier::Create(
-      modcncy::BarrierType::kCentralSenseCounterBarrier);
+  modcncy::Barrier* own_barrier = nullptr;
+  if (barrier == nullptr) {
+    own_barrier = modcncy::Barrier::Create(modcncy::BarrierType::kAdaptive,
+                                           static_cast<int>(num_threads));
+    barrier = own_barrier;
+  }
 
   // Launch threads.
   // Main thread also performs work as thread 0, so loops starts in index 1.
@@ -172,7 +178,7 @@ void blocking(std::complex<float>* data, size_t data_size, size_t num_threads,
   // Join threads.
   // So main thread can acquire the last published changes of the other threads.
   for (auto& thread : threads) thread.join();
-  delete barrier;
+  delete own_barrier;
 }
 
 // =============================================================================
@@ -219,10 +225,18 @@ void lockfree(std::complex<float>* data, size_t data_size, size_t num_threads,
           const size_t segment2_id = segment2_index / segment_size;
 
           // Wait until the segments I need are on my same stage.
+          // This thread's stateful policy, such as a backoff, is reset in place
+          // after every wait to start over, as copying it may allocate. An
+          // address-aware one watches the segment it waits for.
+          modcncy::WatchAddress(&wait_policy,
+                                &segment_stage_count[segment1_id]);
           while (my_stage != segment_stage_count[segment1_id].load())
             wait_policy();
+          modcncy::WatchAddress(&wait_policy,
+                                &segment_stage_count[segment2_id]);
           while (my_stage != segment_stage_count[segment2_id].load())
             wait_policy();
+          modcncy::ResetWaitPolicy(&wait_policy);
 
           butterfly(/*segment1=*/&data[segment1_index],
                     /*segment2=*/&data[segment2_index],
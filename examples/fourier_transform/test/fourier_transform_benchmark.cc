@@ -25,15 +25,28 @@
 //  In this case, it is not the size of an integer, but the size of a complex.
 //  So sizes may vary.
 //
+// + Example usage:
+//
+//   $ make benchmark benchmark_args=--barrier_report=1
+//
+//   It will instrument the barrier of the blocking FFT, and print the skew
+//   between the first and last threads arriving at each stage of the FFT.
+//
 // -----------------------------------------------------------------------------
 
 #include <benchmark/benchmark.h>
+#include <modcncy/barrier.h>
+#include <modcncy/instrumented_barrier.h>
 #include <modcncy/wait_policy.h>
 
+#include <algorithm>
 #include <cmath>
 #include <complex>
 #include <cstdint>
+#include <cstdio>
 #include <functional>
+#include <map>
+#include <memory>
 #include <string>
 #include <thread>  // NOLINT(build/c++11)
 #include <vector>
@@ -57,6 +70,10 @@ MODCNCY_DEFINE_int32(num_threads, std::thread::hardware_concurrency());
 // Waiting policy for threads spinning at a barrier synchronization primitive.
 MODCNCY_DEFINE_string(wait_policy, "cpu_yield");
 
+// If non-zero, the barrier of the blocking FFT is instrumented, and a per-stage
+// imbalance report is printed after all benchmarks.
+MODCNCY_DEFINE_int32(barrier_report, 0);
+
 namespace {
 
 // =============================================================================
@@ -74,6 +91,10 @@ std::function<void()> GetWaitPolicy(const std::string& policy) {
   if (policy == "cpu_no_op") return &modcncy::cpu_no_op;
   if (policy == "cpu_yield") return &modcncy::cpu_yield;
   if (policy == "cpu_pause") return &modcncy::cpu_pause;
+  if (policy == "exponential_backoff")
+    return modcncy::ExponentialBackoffWaitPolicy();
+  if (policy == "monitor_wait") return modcncy::MonitorWaitPolicy();
+  if (policy == "calibrated_pause") return modcncy::CalibratedPauseWaitPolicy();
   return &modcncy::cpu_yield;
 }
 
@@ -95,10 +116,15 @@ void BM_FFT(benchmark::State& state) {  // NOLINT(runtime/references)
   const size_t num_threads = is_sequential(fft_type) ? 1 : FLAGS_num_threads;
   std::function<void()> wait_policy = GetWaitPolicy(FLAGS_wait_policy);
   std::vector<std::complex<float>> data = ComputeSinusoid(data_size);
+  std::unique_ptr<modcncy::InstrumentedBarrier> barrier;
+  if (FLAGS_barrier_report && fft_type == FftType::kParallelBlockingFft)
+    barrier.reset(new modcncy::InstrumentedBarrier(modcncy::Barrier::Create(
+        modcncy::BarrierType::kAdaptive, static_cast<int>(num_threads))));
 
   // Benchmark.
   for (auto _ : state) {
-    FFT(&data[0], data_size, fft_type, num_threads, segment_size, wait_policy);
+    FFT(&data[0], data_size, fft_type, num_threads, segment_size, wait_policy,
+        barrier.get());
 
     // Prepare for next iteration.
     state.PauseTiming();
@@ -116,6 +142,19 @@ void BM_FFT(benchmark::State& state) {  // NOLINT(runtime/references)
                  std::to_string(log2(num_segments)) + " algorithm-stages | " +
                  FLAGS_wait_policy + " wait-policy");
   state.SetBytesProcessed(state.iterations() * data_size * bytes);
+  if (barrier) {
+    const modcncy::BarrierStats stats = barrier->Snapshot();
+    state.counters["skew_p50_us"] = stats.skew.p50_ns / 1e3;
+    state.counters["skew_p99_us"] = stats.skew.p99_ns / 1e3;
+    state.counters["wait_p50_us"] = stats.wait.p50_ns / 1e3;
+    const std::string title = "BM_FFT<FftType(" +
+                              std::to_string(static_cast<int>(fft_type)) +
+                              ")> barrier imbalance:";
+    // The first stage is the FFT of the individual segments, and each of the
+    // others is a stage of the butterfly network.
+    modcncy::ImbalanceReports()[title] =
+        modcncy::ImbalanceReport(title, stats, 1 + log2(num_segments));
+  }
 }
 
 // Register benchmarks.
@@ -139,6 +178,8 @@ int main(int argc, char** argv) {
   benchmark::Initialize(&argc, argv);
   if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
   benchmark::RunSpecifiedBenchmarks();
+  for (const auto& report : modcncy::ImbalanceReports())
+    printf("%s", report.second.c_str());
   benchmark::Shutdown();
 
   return 0;
@@ -9,6 +9,8 @@
 #ifndef EXAMPLES_SORTING_INCLUDE_ALGORITHM_H_
 #define EXAMPLES_SORTING_INCLUDE_ALGORITHM_H_
 
+#include <modcncy/barrier.h>
+#include <modcncy/concurrent_task_queue.h>
 #include <modcncy/wait_policy.h>
 
 #include <algorithm>
@@ -49,7 +51,11 @@ void sort(Iterator begin, Iterator end,
           SortType sort_type = SortType::kSequentialStdSort,
           size_t num_threads = std::thread::hardware_concurrency(),
           size_t segment_size = 1 /*number of elements*/,
-          std::function<void()> wait_policy = &modcncy::cpu_yield) {
+          std::function<void()> wait_policy = &modcncy::cpu_yield,
+          modcncy::Barrier* barrier = nullptr,
+          modcncy::EventCount* event_count = nullptr,
+          modcncy::ConcurrentTaskQueueType queue_type =
+              modcncy::ConcurrentTaskQueueType::kWorkStealingTaskDeque) {
   switch (sort_type) {
     case SortType::kSequentialStdSort:
       std::sort(begin, end);
@@ -64,16 +70,19 @@ void sort(Iterator begin, Iterator end,
       bitonicsort::ompbased(begin, end, num_threads, segment_size);
       break;
     case SortType::kParallelBlockingBitonicsort:
-      bitonicsort::blocking(begin, end, num_threads, segment_size, wait_policy);
+      bitonicsort::blocking(begin, end, num_threads, segment_size, wait_policy,
+                            barrier);
       break;
     case SortType::kParallelLockFreeBitonicsort:
       bitonicsort::lockfree(begin, end, num_threads, segment_size, wait_policy);
       break;
     case SortType::kParallelStealingBitonicsort:
-      bitonicsort::stealing(begin, end, num_threads, segment_size, wait_policy);
+      bitonicsort::stealing(begin, end, num_threads, segment_size, wait_policy,
+                            barrier, queue_type);
       break;
     case SortType::kParallelWaitFreeBitonicsort:
-      bitonicsort::waitfree(begin, end, num_threads, segment_size);
+      bitonicsort::waitfree(begin, end, num_threads, segment_size, wait_policy,
+                            event_count, queue_type);
       break;
     case SortType::kSequentialOriginalOddEvensort:
       oddevensort::original(begin, end);
@@ -85,16 +94,19 @@ void sort(Iterator begin, Iterator end,
       oddevensort::ompbased(begin, end, num_threads, segment_size);
       break;
     case SortType::kParallelBlockingOddEvensort:
-      oddevensort::blocking(begin, end, num_threads, segment_size, wait_policy);
+      oddevensort::blocking(begin, end, num_threads, segment_size, wait_policy,
+                            barrier);
       break;
     case SortType::kParallelLockFreeOddEvensort:
       oddevensort::lockfree(begin, end, num_threads, segment_size, wait_policy);
       break;
     case SortType::kParallelStealingOddEvensort:
-      oddevensort::stealing(begin, end, num_threads, segment_size, wait_policy);
+      oddevensort::stealing(begin, end, num_threads, segment_size, wait_policy,
+                            barrier, queue_type);
       break;
     case SortType::kParallelWaitFreeOddEvensort:
-      oddevensort::waitfree(begin, end, num_threads, segment_size);
+      oddevensort::waitfree(begin, end, num_threads, segment_size, wait_policy,
+                            event_count, queue_type);
       break;
     case SortType::kParallelGnuMultiwayMergesort:
       gnu_impl::multiway_mergesort(begin, end, num_threads);
@@ -45,6 +45,7 @@
 
 #include <modcncy/barrier.h>
 #include <modcncy/concurrent_task_queue.h>
+#include <modcncy/task.h>
 #include <modcncy/wait_policy.h>
 #include <omp.h>
 
@@ -58,6 +59,7 @@
 #include <vector>
 
 #include "examples/sorting/include/merge.h"
+#include "examples/sorting/include/steal.h"
 
 namespace sorting {
 namespace bitonicsort {
@@ -172,10 +174,12 @@ void ompbased(Iterator begin, Iterator end, size_t num_threads,
 
 // =============================================================================
 // Parallel pthreads segmented bitonicsort.
+// Threads synchronize at `barrier` if given, or at their own barrier otherwise.
 template <typename Iterator>
 void blocking(Iterator begin, Iterator end, size_t num_threads,
               size_t segment_size,
-              std::function<void()> wait_policy = &modcncy::cpu_yield) {
+              std::function<void()> wait_policy = &modcncy::cpu_yield,
+              modcncy::Barrier* barrier = nullptr) {
   // Setup.
   const size_t data_size = end - begin;
   const size_t num_segments = data_size / segment_size;
@@ -192,13 +196,16 @@ void blocking(Iterator begin, Iterator end, size_t num_threads,
     const size_t low_index = low_segment * segment_size;
     const size_t high_index = high_segment * segment_size;
     typedef typename std::iterator_traits<Iterator>::value_type value_type;
-    value_type* buffer = new value_type[2 * segment_size];
 
     // Sort each indiviual segment.
     for (size_t i = low_index; i < high_index; i += segment_size)
       std::sort(begin + i, begin + i + segment_size);
 
-    barrier->Wait(num_threads, wait_policy);  // Barrier synchronization.
+    // Barrier synchronization.
+    // The merge buffer is allocated while the other threads are still sorting.
+    const modcncy::Barrier::Token token = barrier->Arrive(num_threads);
+    value_type* buffer = new value_type[2 * segment_size];
+    barrier->Wait(token, wait_policy);
 
     // Bitonic merging network.
     for (size_t k = 2; k <= num_segments; k <<= 1) {
@@ -225,8 +232,12 @@ void blocking(Iterator begin, Iterator end, size_t num_threads,
     delete[] buffer;
   };  // function thread_work
 
-  modcncy::Barrier* barrier = modcncy::Barrier::Create(
-      modcncy::BarrierType::kCentralSenseCounterBarrier);
+  modcncy::Barrier* own_barrier = nullptr;
+  if (barrier == nullptr) {
+    own_barrier = modcncy::Barrier::Create(modcncy::BarrierType::kAdaptive,
+                                           static_cast<int>(num_threads));
+    barrier = own_barrier;
+  }
 
   // Launch threads.
   // Main thread also performs work as thread 0, so loops starts in index 1.
@@ -243,7 +254,7 @@ void blocking(Iterator begin, Iterator end, size_t num_threads,
   // Join threads.
   // So main thread can acquire the last published changes of the other threads.
   for (auto& thread : threads) thread.join();
-  delete barrier;
+  delete own_barrier;
 }
 
 // =============================================================================
@@ -294,10 +305,18 @@ void lockfree(Iterator begin, Iterator end, size_t num_threads,
             const size_t segment2_id = segment2_index / segment_size;
 
             // Wait until the segments I need are on my same stage.
+            // This thread's stateful policy, such as a backoff, is reset in
+            // place after every wait to start over, as copying it may allocate.
+            // An address-aware one watches the segment it waits for.
+            modcncy::WatchAddress(&wait_policy,
+                                  &segment_stage_count[segment1_id]);
             while (my_stage != segment_stage_count[segment1_id].load())
               wait_policy();
+            modcncy::WatchAddress(&wait_policy,
+                                  &segment_stage_count[segment2_id]);
             while (my_stage != segment_stage_count[segment2_id].load())
               wait_policy();
+            modcncy::ResetWaitPolicy(&wait_policy);
 
             if ((i & k) == 0)
               merge::Up(/*segment1=*/&*(begin + segment1_index),
@@ -348,10 +367,15 @@ void lockfree(Iterator begin, Iterator end, size_t num_threads,
 
 // =============================================================================
 // Parallel pthreads segmented bitonicsort plus task stealing.
+// Threads synchronize at `barrier` if given, or at their own barrier otherwise.
+// Each thread keeps its pending tasks in a queue of type `queue_type`.
 template <typename Iterator>
 void stealing(Iterator begin, Iterator end, size_t num_threads,
               size_t segment_size,
-              std::function<void()> wait_policy = &modcncy::cpu_yield) {
+              std::function<void()> wait_policy = &modcncy::cpu_yield,
+              modcncy::Barrier* barrier = nullptr,
+              modcncy::ConcurrentTaskQueueType queue_type =
+                  modcncy::ConcurrentTaskQueueType::kWorkStealingTaskDeque) {
   // Setup.
   const size_t data_size = end - begin;
   const size_t num_segments = data_size / segment_size;
@@ -369,80 +393,106 @@ void stealing(Iterator begin, Iterator end, size_t num_threads,
     const size_t low_index = low_segment * segment_size;
     const size_t high_index = high_segment * segment_size;
 
-    auto execute_tasks = [&](size_t queue_index) {
+    // Every task runs with the context of this thread, so the merges reuse its
+    // scratch buffer.
+    modcncy::WorkerContext worker_context(thread_index);
+    auto execute_tasks = [&]() {
       for (;;) {
-        std::function<void()> task = std::move(queue[queue_index]->Pop());
+        modcncy::Task<> task = queue[thread_index]->Pop();
         if (task == nullptr) break;
-        task();
+        task(worker_context);
       }
     };  // function execute_tasks
 
-    auto steal_tasks = [&]() {
-      for (size_t i = thread_index + 1; i < num_threads + thread_index; ++i)
-        execute_tasks(/*queue_index=*/i % num_threads);
-      wait_policy();
-    };  // function steal_tasks
+    // Thieves steal up to half the tasks of a victim at a time, and run them
+    // before they return from the wait policy, so they do not arrive at the
+    // next barrier with tasks of this stage still pending.
+    modcncy::Task<> stolen_tasks[modcncy::ConcurrentTaskQueue::kMaxStealBatch];
+    auto steal_from = [&](size_t victim_index) {
+      steal::RunStolenTasks(queue[victim_index], stolen_tasks, &worker_context);
+    };  // function steal_from
+
+    // Waiting threads steal tasks from all others. This thread's stateful
+    // policy, such as a backoff, is reset in place after every barrier
+    // synchronization to start over.
+    auto wait = [&]() {
+      barrier->Wait(num_threads, [&] {
+        for (size_t i = thread_index + 1; i < num_threads + thread_index; ++i)
+          steal_from(/*victim_index=*/i % num_threads);
+        wait_policy();
+      });
+      modcncy::ResetWaitPolicy(&wait_policy);
+    };  // function wait
+
+    // Tasks of a stage are pushed all at once.
+    std::vector<modcncy::Task<>> tasks;
+    tasks.reserve(num_segments_per_thread);
+    auto push_tasks = [&]() {
+      queue[thread_index]->PushBulk(tasks.data(), tasks.data() + tasks.size());
+      tasks.clear();
+    };  // function push_tasks
 
     // Sort each indiviual segment.
     for (size_t i = low_index; i < high_index; i += segment_size) {
-      queue[thread_index]->Push(
+      tasks.emplace_back(
           [&, i] { std::sort(begin + i, begin + i + segment_size); });
     }
-    execute_tasks(thread_index);
+    push_tasks();
+    execute_tasks();
 
-    barrier->Wait(num_threads, steal_tasks);  // Barrier synchronization.
+    wait();  // Barrier synchronization.
 
     // Bitonic merging network.
     for (size_t k = 2; k <= num_segments; k <<= 1) {
       for (size_t j = k >> 1; j > 0; j >>= 1) {
         // This barrier is necessary to acquire stealed work from other threads.
-        barrier->Wait(num_threads, steal_tasks);
+        wait();
 
         for (size_t i = low_segment; i < high_segment; ++i) {
           const size_t ij = i ^ j;
           if (i < ij) {
             if ((i & k) == 0)
-              queue[thread_index]->Push([begin, i, ij, segment_size] {
+              tasks.emplace_back([begin, i, ij, segment_size](
+                                     modcncy::WorkerContext& context) {
                 typedef typename std::iterator_traits<Iterator>::value_type val;
-                // TODO(arturogr-dev): There is room for optimization here.
-                // Avoid multiple allocations by allowing arguments in the queue
-                // of tasks and, therefore, reuse the same buffer for all calls.
-                std::vector<val> buffer(2 * segment_size);
                 merge::Up(/*segment1=*/&*(begin + i * segment_size),
                           /*segment2=*/&*(begin + ij * segment_size),
-                          /*buffer=*/buffer.data(),
+                          /*buffer=*/context.Scratch<val>(2 * segment_size),
                           /*segment_size=*/segment_size);
               });
             else
-              queue[thread_index]->Push([begin, i, ij, segment_size] {
+              tasks.emplace_back([begin, i, ij, segment_size](
+                                     modcncy::WorkerContext& context) {
                 typedef typename std::iterator_traits<Iterator>::value_type val;
-                // TODO(arturogr-dev): There is room for optimization here.
-                // Avoid multiple allocations by allowing arguments in the queue
-                // of tasks and, therefore, reuse the same buffer for all calls.
-                std::vector<val> buffer(2 * segment_size);
                 merge::Dn(/*segment1=*/&*(begin + i * segment_size),
                           /*segment2=*/&*(begin + ij * segment_size),
-                          /*buffer=*/buffer.data(),
+                          /*buffer=*/context.Scratch<val>(2 * segment_size),
                           /*segment_size=*/segment_size);
               });
           }
         }
-        execute_tasks(thread_index);
+        push_tasks();
+        execute_tasks();
 
         // This barrier is necessary to publish stealed work to other threads.
-        barrier->Wait(num_threads, steal_tasks);
+        wait();
       }
     }
   };  // function thread_work
 
-  modcncy::Barrier* barrier = modcncy::Barrier::Create(
-      modcncy::BarrierType::kCentralSenseCounterBarrier);
+  modcncy::Barrier* own_barrier = nullptr;
+  if (barrier == nullptr) {
+    own_barrier = modcncy::Barrier::Create(modcncy::BarrierType::kAdaptive,
+                                           static_cast<int>(num_threads));
+    barrier = own_barrier;
+  }
 
   modcncy::ConcurrentTaskQueue** queue =
       new modcncy::ConcurrentTaskQueue*[num_threads];
+  // A thread never keeps more tasks pending than it has segments.
   for (size_t i = 0; i < num_threads; ++i)
     queue[i] = modcncy::ConcurrentTaskQueue::Create(
-        modcncy::ConcurrentTaskQueueType::kBlockingTaskQueue);
+        queue_type, /*capacity=*/num_segments / num_threads);
 
   // Launch threads.
   // Main thread also performs work as thread 0, so loops starts in index 1.
@@ -461,14 +511,22 @@ void stealing(Iterator begin, Iterator end, size_t num_threads,
   for (auto& thread : threads) thread.join();
   for (size_t i = 0; i < num_threads; ++i) delete queue[i];
   delete[] queue;
-  delete barrier;
+  delete own_barrier;
 }
 
 // =============================================================================
 // Parallel non-blocking segmented bitonicsort plus task stealing.
+// Threads waiting for a segment steal tasks, and then wait with `wait_policy`.
+// The `event_count`, if given, is notified every time a segment gets ready, so
+// the policy can park on it. Each thread keeps its pending tasks in a queue of
+// type `queue_type`.
 template <typename Iterator>
 void waitfree(Iterator begin, Iterator end, size_t num_threads,
-              size_t segment_size) {
+              size_t segment_size,
+              std::function<void()> wait_policy = &modcncy::cpu_no_op,
+              modcncy::EventCount* event_count = nullptr,
+              modcncy::ConcurrentTaskQueueType queue_type =
+                  modcncy::ConcurrentTaskQueueType::kWorkStealingTaskDeque) {
   // Setup.
   const size_t data_size = end - begin;
   const size_t num_segments = data_size / segment_size;
@@ -478,6 +536,8 @@ void waitfree(Iterator begin, Iterator end, size_t num_threads,
                         size_t num_segments, size_t segment_size,
                         std::atomic<size_t>* segment_stage_count,
                         std::atomic<size_t>* thread_stage_count,
+                        std::function<void()> wait_policy,
+                        modcncy::EventCount* event_count,
                         modcncy::ConcurrentTaskQueue** queue) {
     // Setup.
     const size_t num_segments_per_thread = num_segments / num_threads;
@@ -486,12 +546,22 @@ void waitfree(Iterator begin, Iterator end, size_t num_threads,
     const size_t low_index = low_segment * segment_size;
     const size_t high_index = high_segment * segment_size;
 
-    auto execute_tasks = [&](size_t thread_index) {
-      for (;;) {
-        std::function<void()> task = std::move(queue[thread_index]->Pop());
-        if (task == nullptr) break;
-        task();
+    // Owners pop their newest tasks. Other threads steal up to half the oldest
+    // ones at a time, and run them right away, as their own queue may be out
+    // of room for them while holding their pending merges. Every task runs
+    // with the context of this thread, so the merges reuse its scratch buffer.
+    modcncy::WorkerContext worker_context(thread_index);
+    modcncy::Task<> stolen_tasks[modcncy::ConcurrentTaskQueue::kMaxStealBatch];
+    auto execute_tasks = [&](size_t queue_index) {
+      if (queue_index == thread_index) {
+        for (;;) {
+          modcncy::Task<> task = queue[queue_index]->Pop();
+          if (task == nullptr) break;
+          task(worker_context);
+        }
+        return;
       }
+      steal::RunStolenTasks(queue[queue_index], stolen_tasks, &worker_context);
     };  // function execute_tasks
 
     auto steal_tasks = [&](size_t stealer_index) {
@@ -500,17 +570,22 @@ void waitfree(Iterator begin, Iterator end, size_t num_threads,
       for (size_t i = stealer_index + 1; i < num_threads + stealer_index; ++i)
         if (stealer_stage >
             thread_stage_count[i % num_threads].load(std::memory_order_relaxed))
-          execute_tasks(/*thread_index=*/i % num_threads);
+          execute_tasks(/*queue_index=*/i % num_threads);
     };  // function steal_tasks
 
+    // The sorts of the segments are pushed all at once.
+    std::vector<modcncy::Task<>> tasks;
+    tasks.reserve(num_segments_per_thread);
     for (size_t i = low_index; i < high_index; i += segment_size) {
-      queue[thread_index]->Push([&, i] {
+      tasks.emplace_back([&, i] {
         // Sort each indiviual segment.
         std::sort(begin + i, begin + i + segment_size);
         // Mark segment "ready" for next stage.
         segment_stage_count[/*segment_id=*/i / segment_size].fetch_add(1);
+        if (event_count != nullptr) event_count->NotifyAll();
       });
     }
+    queue[thread_index]->PushBulk(tasks.data(), tasks.data() + tasks.size());
     execute_tasks(thread_index);
     steal_tasks(thread_index);
 
@@ -529,48 +604,62 @@ void waitfree(Iterator begin, Iterator end, size_t num_threads,
             const size_t segment2_id = segment2_index / segment_size;
 
             // Wait until the segments I need are on my same stage.
+            // This thread's stateful policy, such as a backoff, is reset in
+            // place after every wait to start over, as copying it may allocate.
+            // An address-aware one watches the segment it waits for.
+            modcncy::WatchAddress(&wait_policy,
+                                  &segment_stage_count[segment1_id]);
             while (thread_stage_count[thread_index].load(
                        std::memory_order_relaxed) !=
-                   segment_stage_count[segment1_id].load())
+                   segment_stage_count[segment1_id].load()) {
               steal_tasks(thread_index);
+              wait_policy();
+            }
+            modcncy::WatchAddress(&wait_policy,
+                                  &segment_stage_count[segment2_id]);
             while (thread_stage_count[thread_index].load(
                        std::memory_order_relaxed) !=
-                   segment_stage_count[segment2_id].load())
+                   segment_stage_count[segment2_id].load()) {
               steal_tasks(thread_index);
+              wait_policy();
+            }
+            modcncy::ResetWaitPolicy(&wait_policy);
 
             if ((i & k) == 0) {
               queue[thread_index]->Push(
-                  [begin, segment_stage_count, i, ij, segment1_id, segment2_id,
-                   segment1_index, segment2_index, segment_size] {
+                  [begin, segment_stage_count, event_count, segment1_id,
+                   segment2_id, segment1_index, segment2_index,
+                   segment_size](modcncy::WorkerContext& context) {
                     std::atomic_thread_fence(std::memory_order_acquire);
                     typedef typename std::iterator_traits<Iterator>::value_type
                         value_type;
-                    value_type* buffer = new value_type[2 * segment_size];
                     merge::Up(/*segment1=*/&*(begin + segment1_index),
                               /*segment2=*/&*(begin + segment2_index),
-                              /*buffer=*/buffer,
+                              /*buffer=*/
+                              context.Scratch<value_type>(2 * segment_size),
                               /*segment_size=*/segment_size);
-                    delete[] buffer;
                     // Mark segments "ready" for next stage.
                     segment_stage_count[segment1_id].fetch_add(1);
                     segment_stage_count[segment2_id].fetch_add(1);
+                    if (event_count != nullptr) event_count->NotifyAll();
                   });
             } else {
               queue[thread_index]->Push(
-                  [begin, segment_stage_count, i, ij, segment1_id, segment2_id,
-                   segment1_index, segment2_index, segment_size] {
+                  [begin, segment_stage_count, event_count, segment1_id,
+                   segment2_id, segment1_index, segment2_index,
+                   segment_size](modcncy::WorkerContext& context) {
                     std::atomic_thread_fence(std::memory_order_acquire);
                     typedef typename std::iterator_traits<Iterator>::value_type
                         value_type;
-                    value_type* buffer = new value_type[2 * segment_size];
                     merge::Dn(/*segment1=*/&*(begin + segment1_index),
                               /*segment2=*/&*(begin + segment2_index),
-                              /*buffer=*/buffer,
+                              /*buffer=*/
+                              context.Scratch<value_type>(2 * segment_size),
                               /*segment_size=*/segment_size);
-                    delete[] buffer;
                     // Mark segments "ready" for next stage.
                     segment_stage_count[segment1_id].fetch_add(1);
                     segment_stage_count[segment2_id].fetch_add(1);
+                    if (event_count != nullptr) event_count->NotifyAll();
                   });
             }
           }
@@ -595,9 +684,10 @@ void waitfree(Iterator begin, Iterator end, size_t num_threads,
 
   modcncy::ConcurrentTaskQueue** queue =
       new modcncy::ConcurrentTaskQueue*[num_threads];
+  // A thread never keeps more tasks pending than it has segments.
   for (size_t i = 0; i < num_threads; ++i)
     queue[i] = modcncy::ConcurrentTaskQueue::Create(
-        modcncy::ConcurrentTaskQueueType::kBlockingTaskQueue);
+        queue_type, /*capacity=*/num_segments / num_threads);
 
   // Launch threads.
   // Main thread also performs work as thread 0, so loops starts in index 1.
@@ -606,10 +696,12 @@ void waitfree(Iterator begin, Iterator end, size_t num_threads,
   for (size_t i = 1; i < num_threads; ++i) {
     threads.push_back(std::thread(
         thread_work, begin, /*thread_index=*/i, num_threads, num_segments,
-        segment_size, segment_stage_count, thread_stage_count, queue));
+        segment_size, segment_stage_count, thread_stage_count, wait_policy,
+        event_count, queue));
   }
   thread_work(begin, /*thread_index=*/0, num_threads, num_segments,
-              segment_size, segment_stage_count, thread_stage_count, queue);
+              segment_size, segment_stage_count, thread_stage_count,
+              wait_policy, event_count, queue);
 
   // Join threads.
   // So main thread can acquire the last published changes of the other threads.
@@ -18,20 +18,21 @@
 #ifndef EXAMPLES_SORTING_INCLUDE_MERGE_H_
 #define EXAMPLES_SORTING_INCLUDE_MERGE_H_
 
-#include <cstring>
+#include <algorithm>
+#include <utility>
 
 namespace sorting {
 namespace merge {
 
 // =============================================================================
-// Copies the data from buffer to two segments of the same size. The buffer is
-// two times the size of each segment. The first half of the buffer is copied to
-// `segment1` and the second half of the buffer is copied to `segment2`.
+// Moves the data from buffer to two segments of the same size. The buffer is
+// two times the size of each segment. The first half of the buffer is moved to
+// `segment1` and the second half of the buffer is moved to `segment2`. Trivial
+// data is copied as with `std::memcpy`.
 template <typename T>
 void Scatter(T* buffer, T* segment1, T* segment2, size_t segment_size) {
-  const size_t bytes = segment_size * sizeof(T);
-  std::memcpy(/*dst=*/segment1, /*src=*/buffer, /*cnt=*/bytes);
-  std::memcpy(/*dst=*/segment2, /*src=*/buffer + segment_size, /*cnt=*/bytes);
+  std::move(buffer, buffer + segment_size, segment1);
+  std::move(buffer + segment_size, buffer + 2 * segment_size, segment2);
 }
 
 // =============================================================================
@@ -45,12 +46,12 @@ void UpFromUpUp(T* segment1, T* segment2, T* buffer, size_t segment_size) {
   int64_t i = 0, j = 0, k = 0;
   while (i < size && j < size) {
     if (segment1[i] < segment2[j])
-      buffer[k++] = segment1[i++];
+      buffer[k++] = std::move(segment1[i++]);
     else
-      buffer[k++] = segment2[j++];
+      buffer[k++] = std::move(segment2[j++]);
   }
-  while (i < size) buffer[k++] = segment1[i++];
-  while (j < size) buffer[k++] = segment2[j++];
+  while (i < size) buffer[k++] = std::move(segment1[i++]);
+  while (j < size) buffer[k++] = std::move(segment2[j++]);
   Scatter(buffer, segment1, segment2, size);
 }
 
@@ -65,12 +66,12 @@ void UpFromUpDn(T* segment1, T* segment2, T* buffer, size_t segment_size) {
   int64_t i = 0, j = size - 1, k = 0;
   while (i < size && j >= 0) {
     if (segment1[i] < segment2[j])
-      buffer[k++] = segment1[i++];
+      buffer[k++] = std::move(segment1[i++]);
     else
-      buffer[k++] = segment2[j--];
+      buffer[k++] = std::move(segment2[j--]);
   }
-  while (i < size) buffer[k++] = segment1[i++];
-  while (j >= 0) buffer[k++] = segment2[j--];
+  while (i < size) buffer[k++] = std::move(segment1[i++]);
+  while (j >= 0) buffer[k++] = std::move(segment2[j--]);
   Scatter(buffer, segment1, segment2, size);
 }
 
@@ -85,12 +86,12 @@ void UpFromDnUp(T* segment1, T* segment2, T* buffer, size_t segment_size) {
   int64_t i = size - 1, j = 0, k = 0;
   while (i >= 0 && j < size) {
     if (segment1[i] < segment2[j])
-      buffer[k++] = segment1[i--];
+      buffer[k++] = std::move(segment1[i--]);
     else
-      buffer[k++] = segment2[j++];
+      buffer[k++] = std::move(segment2[j++]);
   }
-  while (i >= 0) buffer[k++] = segment1[i--];
-  while (j < size) buffer[k++] = segment2[j++];
+  while (i >= 0) buffer[k++] = std::move(segment1[i--]);
+  while (j < size) buffer[k++] = std::move(segment2[j++]);
   Scatter(buffer, segment1, segment2, size);
 }
 
@@ -105,12 +106,12 @@ void UpFromDnDn(T* segment1, T* segment2, T* buffer, size_t segment_size) {
   int64_t i = size - 1, j = size - 1, k = 0;
   while (i >= 0 && j >= 0) {
     if (segment1[i] < segment2[j])
-      buffer[k++] = segment1[i--];
+      buffer[k++] = std::move(segment1[i--]);
     else
-      buffer[k++] = segment2[j--];
+      buffer[k++] = std::move(segment2[j--]);
   }
-  while (i >= 0) buffer[k++] = segment1[i--];
-  while (j >= 0) buffer[k++] = segment2[j--];
+  while (i >= 0) buffer[k++] = std::move(segment1[i--]);
+  while (j >= 0) buffer[k++] = std::move(segment2[j--]);
   Scatter(buffer, segment1, segment2, size);
 }
 
@@ -125,12 +126,12 @@ void DnFromUpUp(T* segment1, T* segment2, T* buffer, size_t segment_size) {
   int64_t i = size - 1, j = size - 1, k = 0;
   while (i >= 0 && j >= 0) {
     if (segment1[i] > segment2[j])
-      buffer[k++] = segment1[i--];
+      buffer[k++] = std::move(segment1[i--]);
     else
-      buffer[k++] = segment2[j--];
+      buffer[k++] = std::move(segment2[j--]);
   }
-  while (i >= 0) buffer[k++] = segment1[i--];
-  while (j >= 0) buffer[k++] = segment2[j--];
+  while (i >= 0) buffer[k++] = std::move(segment1[i--]);
+  while (j >= 0) buffer[k++] = std::move(segment2[j--]);
   Scatter(buffer, segment1, segment2, size);
 }
 
@@ -145,12 +146,12 @@ void DnFromUpDn(T* segment1, T* segment2, T* buffer, size_t segment_size) {
   int64_t i = size - 1, j = 0, k = 0;
   while (i >= 0 && j < size) {
     if (segment1[i] > segment2[j])
-      buffer[k++] = segment1[i--];
+      buffer[k++] = std::move(segment1[i--]);
     else
-      buffer[k++] = segment2[j++];
+      buffer[k++] = std::move(segment2[j++]);
   }
-  while (i >= 0) buffer[k++] = segment1[i--];
-  while (j < size) buffer[k++] = segment2[j++];
+  while (i >= 0) buffer[k++] = std::move(segment1[i--]);
+  while (j < size) buffer[k++] = std::move(segment2[j++]);
   Scatter(buffer, segment1, segment2, size);
 }
 
@@ -165,12 +166,12 @@ void DnFromDnUp(T* segment1, T* segment2, T* buffer, size_t segment_size) {
   int64_t i = 0, j = size - 1, k = 0;
   while (i < size && j >= 0) {
     if (segment1[i] > segment2[j])
-      buffer[k++] = segment1[i++];
+      buffer[k++] = std::move(segment1[i++]);
     else
-      buffer[k++] = segment2[j--];
+      buffer[k++] = std::move(segment2[j--]);
   }
-  while (i < size) buffer[k++] = segment1[i++];
-  while (j >= 0) buffer[k++] = segment2[j--];
+  while (i < size) buffer[k++] = std::move(segment1[i++]);
+  while (j >= 0) buffer[k++] = std::move(segment2[j--]);
   Scatter(buffer, segment1, segment2, size);
 }
 
@@ -185,12 +186,12 @@ void DnFromDnDn(T* segment1, T* segment2, T* buffer, size_t segment_size) {
   int64_t i = 0, j = 0, k = 0;
   while (i < size && j < size) {
     if (segment1[i] > segment2[j])
-      buffer[k++] = segment1[i++];
+      buffer[k++] = std::move(segment1[i++]);
     else
-      buffer[k++] = segment2[j++];
+      buffer[k++] = std::move(segment2[j++]);
   }
-  while (i < size) buffer[k++] = segment1[i++];
-  while (j < size) buffer[k++] = segment2[j++];
+  while (i < size) buffer[k++] = std::move(segment1[i++]);
+  while (j < size) buffer[k++] = std::move(segment2[j++]);
   Scatter(buffer, segment1, segment2, size);
 }
 
@@ -0,0 +1,65 @@
+// Copyright 2022 The Modcncy Authors. All rights reserved.
+// Use of this source code is governed by the license found in the LICENSE file.
+// -----------------------------------------------------------------------------
+//
+// Helper functions for the segmented sorts whose idle threads steal the merges
+// of other threads. A thief takes up to half the oldest tasks of a victim at a
+// time, and runs them right away with its own worker context:
+//
+//   modcncy::Task<> stolen_tasks[modcncy::ConcurrentTaskQueue::kMaxStealBatch];
+//   ...
+//   steal::RunStolenTasks(queue[victim_index], stolen_tasks, &worker_context);
+//
+// Stolen tasks are never moved into the queue of the thief, where a third
+// thread could steal them again. That thread may already be waiting for the
+// next stage, so a stage could start while tasks of the previous one are still
+// pending. Instead, a thief holds its stolen tasks until it has run them, and
+// it only moves on to the next stage afterwards.
+//
+// -----------------------------------------------------------------------------
+
+#ifndef EXAMPLES_SORTING_INCLUDE_STEAL_H_
+#define EXAMPLES_SORTING_INCLUDE_STEAL_H_
+
+#include <modcncy/concurrent_task_queue.h>
+#include <modcncy/task.h>
+
+#include <atomic>
+#include <chrono>  // NOLINT(build/c++11)
+#include <cstddef>
+#include <cstdint>
+#include <thread>  // NOLINT(build/c++11)
+
+namespace sorting {
+namespace steal {
+
+// =============================================================================
+// Returns how long thieves sleep between stealing tasks and running them, in
+// nanoseconds. Zero, unless a test widens that window to stress the sorts.
+inline std::atomic<int64_t>& DelayNs() {
+  static std::atomic<int64_t> delay_ns{0};
+  return delay_ns;
+}
+
+// =============================================================================
+// Steals up to half the tasks of `victim` at a time into `stolen_tasks`, which
+// holds up to `kMaxStealBatch` of them, and runs them with `context`. Returns
+// once `victim` has no tasks left to steal.
+inline void RunStolenTasks(modcncy::ConcurrentTaskQueue* victim,
+                           modcncy::Task<>* stolen_tasks,
+                           modcncy::WorkerContext* context) {
+  for (;;) {
+    const size_t num_stolen_tasks = victim->StealBatch(
+        stolen_tasks, modcncy::ConcurrentTaskQueue::kMaxStealBatch);
+    if (num_stolen_tasks == 0) break;
+    const int64_t delay_ns = DelayNs().load(std::memory_order_relaxed);
+    if (delay_ns > 0)
+      std::this_thread::sleep_for(std::chrono::nanoseconds(delay_ns));
+    for (size_t i = 0; i < num_stolen_tasks; ++i) stolen_tasks[i](*context);
+  }
+}
+
+}  // namespace steal
+}  // namespace sorting
+
+#endif  // EXAMPLES_SORTING_INCLUDE_STEAL_H_
@@ -22,15 +22,52 @@
 //     -> data_size = 1 << 22 = 4194304 [elements] = 16384 [kB]
 //     -> segment_size = 2048 [elements] =  8192 [bytes]
 //
+// + Example usage:
+//
+//   $ make benchmark benchmark_args=--barrier_report=1
+//
+//   It will instrument the barrier of the blocking sorts, and print the skew
+//   between the first and last threads arriving at each stage of the sort.
+//
+// + Example usage:
+//
+//   $ make benchmark benchmark_args=--wait_policy=spin_yield_park
+//
+//   Threads of the blocking, stealing and wait-free sorts pause, then yield,
+//   and then park until notified. The other sorts yield instead.
+//
+// + Example usage:
+//
+//   $ make benchmark benchmark_args=--task_queue=bounded_lockfree
+//
+//   Threads of the stealing and wait-free sorts keep their pending tasks in
+//   bounded lock-free queues, instead of work-stealing deques. Use
+//   "unbounded_lockfree" for lock-free linked queues, and "blocking" for queues
+//   taking a mutex on every access.
+//
+// + Example usage:
+//
+//   $ make benchmark benchmark_args=--wait_policy=adaptive
+//
+//   Threads spin while the waits of the sort are expected to be short, as
+//   learned from its recent waits, and park when they are expected to be long.
+//   Threads of the sorts not notifying their waits yield instead of parking.
+//
 // -----------------------------------------------------------------------------
 
 #include <benchmark/benchmark.h>
+#include <modcncy/barrier.h>
+#include <modcncy/concurrent_task_queue.h>
+#include <modcncy/instrumented_barrier.h>
 #include <modcncy/wait_policy.h>
 
 #include <algorithm>
 #include <cassert>
 #include <cstdint>
+#include <cstdio>
 #include <functional>
+#include <map>
+#include <memory>
 #include <random>
 #include <string>
 #include <thread>  // NOLINT(build/c++11)
@@ -55,6 +92,14 @@ MODCNCY_DEFINE_int32(num_threads, std::thread::hardware_concurrency());
 // Waiting policy for threads spinning at a barrier synchronization primitive.
 MODCNCY_DEFINE_string(wait_policy, "cpu_yield");
 
+// Queue of pending tasks of the stealing and wait-free sorts: "work_stealing",
+// "blocking", "bounded_lockfree" or "unbounded_lockfree".
+MODCNCY_DEFINE_string(task_queue, "work_stealing");
+
+// If non-zero, the barrier of the blocking sorts is instrumented, and a
+// per-stage imbalance report is printed after all benchmarks.
+MODCNCY_DEFINE_int32(barrier_report, 0);
+
 namespace {
 
 // =============================================================================
@@ -98,6 +143,28 @@ bool is_waitfree(SortType sort_type) {
          sort_type == SortType::kParallelWaitFreeOddEvensort;
 }
 
+// =============================================================================
+// Verifies if a barrier-based sort implementation is executed.
+bool is_blocking(SortType sort_type) {
+  return sort_type == SortType::kParallelBlockingBitonicsort ||
+         sort_type == SortType::kParallelBlockingOddEvensort;
+}
+
+// =============================================================================
+// Verifies if a stealing-barrier sort implementation is executed.
+bool is_stealing(SortType sort_type) {
+  return sort_type == SortType::kParallelStealingBitonicsort ||
+         sort_type == SortType::kParallelStealingOddEvensort;
+}
+
+// =============================================================================
+// Verifies if the executed sort implementation notifies its waiting threads, so
+// they can park.
+bool is_notifying(SortType sort_type) {
+  return is_blocking(sort_type) || is_stealing(sort_type) ||
+         is_waitfree(sort_type);
+}
+
 // =============================================================================
 // Computes the logarithm base 2 of a power of 2.
 size_t log2(size_t x) { return __builtin_ctz(x); }
@@ -115,14 +182,28 @@ std::string algorithm_stages_label(size_t num_segments, SortType sort_type) {
 // Returns the applied wait policy.
 std::string wait_policy_label(const std::string& policy, SortType sort_type) {
   if ((is_bitonicsort(sort_type) || is_oddevensort(sort_type)) &&
-      !is_sequential(sort_type) && !is_waitfree(sort_type)) {
-    if (policy == "cpu_no_op" || policy == "cpu_yield" || policy == "cpu_pause")
+      !is_sequential(sort_type)) {
+    if (policy == "cpu_no_op" || policy == "cpu_yield" ||
+        policy == "cpu_pause" || policy == "exponential_backoff" ||
+        policy == "monitor_wait" || policy == "calibrated_pause" ||
+        policy == "adaptive")
       return policy;
+    if (policy == "spin_yield_park" && is_notifying(sort_type)) return policy;
     return "cpu_yield";
   }
   return "N/A";
 }
 
+// =============================================================================
+// Returns the number of barrier synchronizations of one run of a blocking sort.
+// The first one follows the sort of the individual segments, and each of the
+// others follows a stage of the merging network.
+size_t num_barrier_stages(size_t num_segments, SortType sort_type) {
+  if (sort_type == SortType::kParallelBlockingBitonicsort)
+    return 1 + (log2(num_segments) * (log2(num_segments) + 1)) / 2;
+  return 1 + num_segments;
+}
+
 // =============================================================================
 // Verifies if the data is sorted in non-descending order.
 template <typename T>
@@ -133,10 +214,45 @@ bool IsSorted(const std::vector<T>& data) {
 }
 
 // =============================================================================
-std::function<void()> GetWaitPolicy(const std::string& policy) {
+// Returns the applied task queue.
+std::string task_queue_label(const std::string& queue, SortType sort_type) {
+  if (!is_stealing(sort_type) && !is_waitfree(sort_type)) return "N/A";
+  if (queue == "blocking" || queue == "bounded_lockfree" ||
+      queue == "unbounded_lockfree")
+    return queue;
+  return "work_stealing";
+}
+
+// =============================================================================
+// Returns the type of the task queues named `queue`, work-stealing deques by
+// default.
+modcncy::ConcurrentTaskQueueType GetTaskQueueType(const std::string& queue) {
+  if (queue == "blocking")
+    return modcncy::ConcurrentTaskQueueType::kBlockingTaskQueue;
+  if (queue == "bounded_lockfree")
+    return modcncy::ConcurrentTaskQueueType::kBoundedLockFreeTaskQueue;
+  if (queue == "unbounded_lockfree")
+    return modcncy::ConcurrentTaskQueueType::kUnboundedLockFreeTaskQueue;
+  return modcncy::ConcurrentTaskQueueType::kWorkStealingTaskDeque;
+}
+
+// =============================================================================
+// Parking policies park on `event_count`, and fall back to yielding without it.
+// Adaptive policies learn the recent waits in `wait_estimate`.
+std::function<void()> GetWaitPolicy(const std::string& policy,
+                                    modcncy::EventCount* event_count,
+                                    modcncy::WaitEstimate* wait_estimate) {
   if (policy == "cpu_no_op") return &modcncy::cpu_no_op;
   if (policy == "cpu_yield") return &modcncy::cpu_yield;
   if (policy == "cpu_pause") return &modcncy::cpu_pause;
+  if (policy == "exponential_backoff")
+    return modcncy::ExponentialBackoffWaitPolicy();
+  if (policy == "monitor_wait") return modcncy::MonitorWaitPolicy();
+  if (policy == "calibrated_pause") return modcncy::CalibratedPauseWaitPolicy();
+  if (policy == "spin_yield_park" && event_count != nullptr)
+    return modcncy::SpinYieldParkWaitPolicy(event_count);
+  if (policy == "adaptive")
+    return modcncy::AdaptiveWaitPolicy(wait_estimate, event_count);
   return &modcncy::cpu_yield;
 }
 
@@ -149,18 +265,38 @@ void BM_Sort(benchmark::State& state) {  // NOLINT(runtime/references)
   const size_t segment_size = FLAGS_segment_size;
   const size_t num_segments = data_size / segment_size;
   const size_t num_threads = is_sequential(sort_type) ? 1 : FLAGS_num_threads;
-  std::function<void()> wait_policy = GetWaitPolicy(FLAGS_wait_policy);
+  std::unique_ptr<modcncy::EventCount> event_count;
+  if ((FLAGS_wait_policy == "spin_yield_park" ||
+       FLAGS_wait_policy == "adaptive") &&
+      is_notifying(sort_type))
+    event_count.reset(new modcncy::EventCount());
+  modcncy::WaitEstimate wait_estimate;
+  std::function<void()> wait_policy =
+      GetWaitPolicy(FLAGS_wait_policy, event_count.get(), &wait_estimate);
   std::vector<T> data(data_size);
   for (size_t i = 0; i < data_size; ++i) data[i] = static_cast<T>(i);
   std::random_device rand_dev;
   std::mt19937 rand_gen(rand_dev());
   std::shuffle(data.begin(), data.end(), rand_gen);
   assert(!IsSorted(data) && "Data should not be sorted after shuffle");
+  std::unique_ptr<modcncy::Barrier> barrier;
+  modcncy::InstrumentedBarrier* instrumented_barrier = nullptr;
+  if (FLAGS_barrier_report && is_blocking(sort_type)) {
+    instrumented_barrier =
+        new modcncy::InstrumentedBarrier(modcncy::Barrier::Create(
+            modcncy::BarrierType::kAdaptive, static_cast<int>(num_threads)));
+    barrier.reset(instrumented_barrier);
+  } else if (event_count && !is_waitfree(sort_type)) {
+    barrier.reset(modcncy::Barrier::Create(modcncy::BarrierType::kAdaptive,
+                                           static_cast<int>(num_threads)));
+  }
+  if (barrier && event_count) barrier->SetEventCount(event_count.get());
 
   // Benchmark.
   for (auto _ : state) {
     sort(data.begin(), data.end(), sort_type, num_threads, segment_size,
-         wait_policy);
+         wait_policy, barrier.get(), event_count.get(),
+         GetTaskQueueType(FLAGS_task_queue));
 
     // Prepare for next iteration.
     state.PauseTiming();
@@ -178,8 +314,21 @@ void BM_Sort(benchmark::State& state) {  // NOLINT(runtime/references)
       std::to_string(num_segments) + " num_segments | " +
       std::to_string(num_threads) + " num_threads | " +
       algorithm_stages_label(num_segments, sort_type) + " algorithm-stages | " +
-      wait_policy_label(FLAGS_wait_policy, sort_type) + " wait-policy");
+      wait_policy_label(FLAGS_wait_policy, sort_type) + " wait-policy | " +
+      task_queue_label(FLAGS_task_queue, sort_type) + " task-queue");
   state.SetBytesProcessed(state.iterations() * data_size * sizeof(T));
+  if (instrumented_barrier) {
+    const modcncy::BarrierStats stats = instrumented_barrier->Snapshot();
+    state.counters["skew_p50_us"] = stats.skew.p50_ns / 1e3;
+    state.counters["skew_p99_us"] = stats.skew.p99_ns / 1e3;
+    state.counters["wait_p50_us"] = stats.wait.p50_ns / 1e3;
+    const std::string title = "BM_Sort<int" + std::to_string(8 * sizeof(T)) +
+                              "_t, SortType(" +
+                              std::to_string(static_cast<int>(sort_type)) +
+                              ")> barrier imbalance:";
+    modcncy::ImbalanceReports()[title] = modcncy::ImbalanceReport(
+        title, stats, num_barrier_stages(num_segments, sort_type));
+  }
 }
 
 // Register benchmarks.
@@ -302,6 +451,8 @@ int main(int argc, char** argv) {
   benchmark::Initialize(&argc, argv);
   if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
   benchmark::RunSpecifiedBenchmarks();
+  for (const auto& report : modcncy::ImbalanceReports())
+    printf("%s", report.second.c_str());
   benchmark::Shutdown();
 
   return 0;
@@ -18,6 +18,8 @@ MODCNCY_DECLARE_int32(input_shift);
 MODCNCY_DECLARE_int32(segment_size);
 MODCNCY_DECLARE_int32(num_threads);
 MODCNCY_DECLARE_string(wait_policy);
+MODCNCY_DECLARE_string(task_queue);
+MODCNCY_DECLARE_int32(barrier_report);
 
 // =============================================================================
 // Parses the declared command line flags.
@@ -26,7 +28,10 @@ void ParseCommandLineFlags(int* argc, char** argv) {
     if (modcncy::ParseInt32Flag(argv[i], "input_shift", &FLAGS_input_shift) ||
         modcncy::ParseInt32Flag(argv[i], "segment_size", &FLAGS_segment_size) ||
         modcncy::ParseInt32Flag(argv[i], "num_threads", &FLAGS_num_threads) ||
-        modcncy::ParseStringFlag(argv[i], "wait_policy", &FLAGS_wait_policy)) {
+        modcncy::ParseStringFlag(argv[i], "wait_policy", &FLAGS_wait_policy) ||
+        modcncy::ParseStringFlag(argv[i], "task_queue", &FLAGS_task_queue) ||
+        modcncy::ParseInt32Flag(argv[i], "barrier_report",
+                                &FLAGS_barrier_report)) {
       for (int j = i; j != *argc - 1; ++j) argv[j] = argv[j + 1];
       --(*argc);
       --i;
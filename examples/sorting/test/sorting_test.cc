@@ -3,7 +3,13 @@
 // -----------------------------------------------------------------------------
 
 #include <gtest/gtest.h>
+#include <modcncy/barrier.h>
+#include <modcncy/concurrent_task_queue.h>
+#include <modcncy/wait_policy.h>
 
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
 #include <vector>
 
 #include "examples/sorting/include/algorithm.h"
@@ -61,5 +67,162 @@ TEST_P(SortingCorrectnessTest, Sort32BitIntsWithDefaultArguments) {
   EXPECT_EQ(unsorted, sorted);
 }
 
+// =============================================================================
+TEST_P(SortingCorrectnessTest, SortStrings) {
+  // Strings too long for the small string optimization live on the heap, so
+  // mishandled copies of them do not go unnoticed.
+  constexpr size_t size = 2048;
+  std::vector<std::string> sorted(size);
+  std::vector<std::string> unsorted(size);
+  for (size_t i = 0; i < size; ++i) {
+    unsorted[i] = std::string(32, 'a') + std::to_string(size + size - i - 1);
+    sorted[i] = std::string(32, 'a') + std::to_string(size + i);
+  }
+  sort(unsorted.begin(), unsorted.end(), /*sort_type=*/GetParam(),
+       /*num_threads=*/2, /*segment_size=*/256);
+  EXPECT_EQ(unsorted, sorted);
+}
+
+// =============================================================================
+TEST(SortingTaskQueueTest, Sort32BitIntsWithEveryTaskQueue) {
+  constexpr size_t size = 2048;
+  std::vector<int32_t> sorted(size);
+  for (size_t i = 0; i < size; ++i) sorted[i] = i;
+
+  // Every thread fills its queue up to capacity with the sorts of its segments.
+  for (modcncy::ConcurrentTaskQueueType queue_type :
+       {modcncy::ConcurrentTaskQueueType::kBlockingTaskQueue,
+        modcncy::ConcurrentTaskQueueType::kBoundedLockFreeTaskQueue,
+        modcncy::ConcurrentTaskQueueType::kWorkStealingTaskDeque,
+        modcncy::ConcurrentTaskQueueType::kUnboundedLockFreeTaskQueue}) {
+    for (size_t num_threads : {1, 2, 4}) {
+      for (SortType sort_type : {SortType::kParallelStealingBitonicsort,
+                                 SortType::kParallelWaitFreeBitonicsort,
+                                 SortType::kParallelStealingOddEvensort,
+                                 SortType::kParallelWaitFreeOddEvensort}) {
+        std::vector<int32_t> unsorted(size);
+        for (size_t i = 0; i < size; ++i) unsorted[i] = size - i - 1;
+        sort(unsorted.begin(), unsorted.end(), sort_type, num_threads,
+             /*segment_size=*/64, &modcncy::cpu_yield, /*barrier=*/nullptr,
+             /*event_count=*/nullptr, queue_type);
+        EXPECT_EQ(unsorted, sorted);
+      }
+    }
+  }
+}
+
+// =============================================================================
+// Integer yielding the CPU on every comparison, so threads interleave within
+// the merges, and a stale merge overlaps the merges of the next stage.
+struct SlowInt {
+  int32_t value;
+  friend bool operator<(const SlowInt& lhs, const SlowInt& rhs) {
+    std::this_thread::yield();
+    return lhs.value < rhs.value;
+  }
+  friend bool operator>(const SlowInt& lhs, const SlowInt& rhs) {
+    return rhs < lhs;
+  }
+  friend bool operator==(const SlowInt& lhs, const SlowInt& rhs) {
+    return lhs.value == rhs.value;
+  }
+};  // struct SlowInt
+
+// =============================================================================
+TEST(SortingTaskQueueTest, StolenTasksFinishBeforeTheNextStage) {
+  constexpr size_t size = 1024;
+  constexpr size_t num_threads = 8;
+  constexpr int num_runs = 10;
+  std::vector<SlowInt> sorted(size);
+  for (size_t i = 0; i < size; ++i) sorted[i].value = i;
+  // Waiting threads steal in the wait policy, which this barrier always calls.
+  std::unique_ptr<modcncy::Barrier> barrier(modcncy::Barrier::Create(
+      modcncy::BarrierType::kCentralSenseCounterBarrier));
+
+  // Thieves hold their stolen tasks for long before running them, so a stage
+  // starting before they are done would merge segments still being merged.
+  steal::DelayNs().store(200 * 1000);
+  for (modcncy::ConcurrentTaskQueueType queue_type :
+       {modcncy::ConcurrentTaskQueueType::kBlockingTaskQueue,
+        modcncy::ConcurrentTaskQueueType::kWorkStealingTaskDeque}) {
+    for (SortType sort_type : {SortType::kParallelStealingBitonicsort,
+                               SortType::kParallelWaitFreeBitonicsort,
+                               SortType::kParallelStealingOddEvensort,
+                               SortType::kParallelWaitFreeOddEvensort}) {
+      for (int run = 0; run < num_runs; ++run) {
+        std::vector<SlowInt> unsorted(size);
+        for (size_t i = 0; i < size; ++i) unsorted[i].value = size - i - 1;
+        sort(unsorted.begin(), unsorted.end(), sort_type, num_threads,
+             /*segment_size=*/16, &modcncy::cpu_yield, barrier.get(),
+             /*event_count=*/nullptr, queue_type);
+        EXPECT_EQ(unsorted, sorted);
+      }
+    }
+  }
+
+  // Teardown.
+  steal::DelayNs().store(0);
+}
+
+// =============================================================================
+TEST(SortingParkedWaitingTest, Sort32BitIntsWithSpinYieldParkWaitPolicy) {
+  constexpr size_t size = 2048;
+  constexpr size_t num_threads = 4;
+  std::vector<int32_t> sorted(size);
+  for (size_t i = 0; i < size; ++i) sorted[i] = i;
+  modcncy::EventCount event_count;
+  std::unique_ptr<modcncy::Barrier> barrier(modcncy::Barrier::Create(
+      modcncy::BarrierType::kAdaptive, static_cast<int>(num_threads)));
+  barrier->SetEventCount(&event_count);
+
+  // Threads park almost right away, so only notifications wake them up.
+  for (SortType sort_type : {SortType::kParallelBlockingBitonicsort,
+                             SortType::kParallelStealingBitonicsort,
+                             SortType::kParallelWaitFreeBitonicsort,
+                             SortType::kParallelBlockingOddEvensort,
+                             SortType::kParallelStealingOddEvensort,
+                             SortType::kParallelWaitFreeOddEvensort}) {
+    std::vector<int32_t> unsorted(size);
+    for (size_t i = 0; i < size; ++i) unsorted[i] = size - i - 1;
+    sort(unsorted.begin(), unsorted.end(), sort_type, num_threads,
+         /*segment_size=*/128,
+         modcncy::SpinYieldParkWaitPolicy(&event_count, /*num_spins=*/1,
+                                          /*num_yields=*/1),
+         barrier.get(), &event_count);
+    EXPECT_EQ(unsorted, sorted);
+  }
+}
+
+// =============================================================================
+TEST(SortingParkedWaitingTest, Sort32BitIntsWithAdaptiveWaitPolicy) {
+  constexpr size_t size = 2048;
+  constexpr size_t num_threads = 4;
+  std::vector<int32_t> sorted(size);
+  for (size_t i = 0; i < size; ++i) sorted[i] = i;
+  modcncy::EventCount event_count;
+  std::unique_ptr<modcncy::Barrier> barrier(modcncy::Barrier::Create(
+      modcncy::BarrierType::kAdaptive, static_cast<int>(num_threads)));
+  barrier->SetEventCount(&event_count);
+
+  // Waits are expected to be long from the start, so threads park right after
+  // spinning for a while, and only notifications wake them up.
+  modcncy::WaitEstimate wait_estimate;
+  wait_estimate.Record(1000 * 1000 * 1000);
+  for (SortType sort_type : {SortType::kParallelBlockingBitonicsort,
+                             SortType::kParallelStealingBitonicsort,
+                             SortType::kParallelWaitFreeBitonicsort,
+                             SortType::kParallelBlockingOddEvensort,
+                             SortType::kParallelStealingOddEvensort,
+                             SortType::kParallelWaitFreeOddEvensort}) {
+    std::vector<int32_t> unsorted(size);
+    for (size_t i = 0; i < size; ++i) unsorted[i] = size - i - 1;
+    sort(unsorted.begin(), unsorted.end(), sort_type, num_threads,
+         /*segment_size=*/128,
+         modcncy::AdaptiveWaitPolicy(&wait_estimate, &event_count),
+         barrier.get(), &event_count);
+    EXPECT_EQ(unsorted, sorted);
+  }
+}
+
 }  // namespace
 }  // namespace sorting
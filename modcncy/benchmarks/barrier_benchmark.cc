@@ -4,12 +4,59 @@
 
 #include <benchmark/benchmark.h>
 #include <modcncy/barrier.h>
+#include <modcncy/reducing_barrier.h>
+#include <modcncy/templated_barrier.h>
+#include <modcncy/thread_affinity.h>
+#include <modcncy/wait_policy.h>
 
+#include <time.h>
+
+#include <atomic>
+#include <chrono>  // NOLINT(build/c++11)
+#include <cstdint>
+#include <random>
 #include <thread>  // NOLINT(build/c++11)
 
 namespace modcncy {
 namespace {
 
+// =============================================================================
+// Keeps current thread busy for `duration_ns` nanoseconds, standing for the
+// work done between two barrier synchronizations.
+void SyntheticWork(int64_t duration_ns) {
+  const auto end = std::chrono::steady_clock::now() +
+                   std::chrono::nanoseconds(duration_ns);
+  while (std::chrono::steady_clock::now() < end) {
+  }
+}
+
+// =============================================================================
+// Returns the CPU time consumed so far by all threads of the process, in
+// nanoseconds.
+int64_t ProcessCpuTimeNs() {
+  timespec time;
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &time);
+  return time.tv_sec * 1000000000LL + time.tv_nsec;
+}
+
+// =============================================================================
+// Pins the calling benchmark thread across NUMA nodes. Threads only run the
+// benchmark if all of them were pinned, since a thread skipping it would leave
+// the others waiting for it at the barrier. Returns `false` if it is skipped.
+bool PinAcrossNodesOrSkip(benchmark::State& state) {  // NOLINT
+  static CentralSenseCounterBarrierT<YieldWaitPolicy> setup_barrier;
+  static std::atomic<int> num_unpinned{0};
+  if (!PinThreadAcrossNodes(state.thread_index())) num_unpinned.fetch_add(1);
+  setup_barrier.Wait(state.threads());
+  const bool all_pinned = num_unpinned.load() == 0;
+  setup_barrier.Wait(state.threads());
+  if (state.thread_index() == 0) num_unpinned.store(0);
+  if (all_pinned) return true;
+  UnpinThread();
+  state.SkipWithError("Some thread could not be pinned.");
+  return false;
+}
+
 // =============================================================================
 // Benchmark: Barrier Synchronization Primitive.
 template <BarrierType barrier_type>
@@ -31,12 +78,469 @@ void BM_Barrier(benchmark::State& state) {  // NOLINT(runtime/references)
   }
 }
 
+// =============================================================================
+// Benchmark: Barrier Synchronization Primitive, providing thread identities.
+template <BarrierType barrier_type>
+void BM_BarrierWithThreadId(benchmark::State& state) {  // NOLINT
+  // Setup.
+  const auto& num_threads = state.threads();
+  const auto& thread_id = state.thread_index();
+  static Barrier* barrier = nullptr;
+  if (state.thread_index() == 0) {
+    barrier = modcncy::Barrier::Create(barrier_type);
+  }
+  // Benchmark.
+  for (auto _ : state) {
+    barrier->Wait(num_threads, thread_id);
+  }
+  // Teardown.
+  if (state.thread_index() == 0) {
+    state.SetItemsProcessed(state.iterations());
+    delete barrier;
+  }
+}
+
+// =============================================================================
+// Benchmark: Barrier Synchronization Primitive, with threads pinned round-robin
+// across NUMA nodes (sockets).
+template <BarrierType barrier_type>
+void BM_BarrierPinnedAcrossNodes(benchmark::State& state) {  // NOLINT
+  // Setup.
+  const auto& num_threads = state.threads();
+  static Barrier* barrier = nullptr;
+  if (state.thread_index() == 0) {
+    barrier = modcncy::Barrier::Create(barrier_type, num_threads);
+  }
+  PinAcrossNodesOrSkip(state);
+  // Benchmark.
+  for (auto _ : state) {
+    barrier->Wait(num_threads);
+  }
+  // Teardown.
+  UnpinThread();
+  if (state.thread_index() == 0) {
+    state.SetItemsProcessed(state.iterations());
+    state.counters["numa_nodes"] = NumNumaNodes();
+    delete barrier;
+  }
+}
+
+// =============================================================================
+// Benchmark: Barrier Synchronization Primitive, with a runtime wait policy.
+template <BarrierType barrier_type, void (*policy)()>
+void BM_BarrierWithPolicy(benchmark::State& state) {  // NOLINT
+  // Setup.
+  const auto& num_threads = state.threads();
+  static Barrier* barrier = nullptr;
+  if (state.thread_index() == 0) {
+    barrier = modcncy::Barrier::Create(barrier_type);
+  }
+  // Benchmark.
+  for (auto _ : state) {
+    barrier->Wait(num_threads, policy);
+  }
+  // Teardown.
+  if (state.thread_index() == 0) {
+    state.SetItemsProcessed(state.iterations());
+    delete barrier;
+  }
+}
+
+// =============================================================================
+// Benchmark: Barrier Synchronization Primitive, backing off exponentially.
+template <BarrierType barrier_type>
+void BM_BarrierWithBackoff(benchmark::State& state) {  // NOLINT
+  // Setup.
+  const auto& num_threads = state.threads();
+  static Barrier* barrier = nullptr;
+  if (state.thread_index() == 0) {
+    barrier = modcncy::Barrier::Create(barrier_type);
+  }
+  // Benchmark.
+  for (auto _ : state) {
+    barrier->Wait(num_threads, ExponentialBackoffWaitPolicy());
+  }
+  // Teardown.
+  if (state.thread_index() == 0) {
+    state.SetItemsProcessed(state.iterations());
+    delete barrier;
+  }
+}
+
+// =============================================================================
+// Benchmark: Barrier Synchronization Primitive, monitoring the spun address.
+template <BarrierType barrier_type>
+void BM_BarrierWithMonitorWait(benchmark::State& state) {  // NOLINT
+  // Setup.
+  const auto& num_threads = state.threads();
+  static Barrier* barrier = nullptr;
+  if (state.thread_index() == 0) {
+    barrier = modcncy::Barrier::Create(barrier_type);
+  }
+  // Benchmark.
+  for (auto _ : state) {
+    barrier->Wait(num_threads, MonitorWaitPolicy());
+  }
+  // Teardown.
+  if (state.thread_index() == 0) {
+    state.SetItemsProcessed(state.iterations());
+    state.SetLabel(cpu_has_waitpkg() ? "waitpkg" : "no waitpkg, paused");
+    delete barrier;
+  }
+}
+
+// =============================================================================
+// Benchmark: Barrier Synchronization Primitive, spinning, yielding and parking.
+template <BarrierType barrier_type>
+void BM_BarrierWithParking(benchmark::State& state) {  // NOLINT
+  // Setup.
+  const auto& num_threads = state.threads();
+  static Barrier* barrier = nullptr;
+  static EventCount* event_count = nullptr;
+  if (state.thread_index() == 0) {
+    event_count = new EventCount();
+    barrier = modcncy::Barrier::Create(barrier_type);
+    barrier->SetEventCount(event_count);
+  }
+  // Benchmark.
+  for (auto _ : state) {
+    barrier->Wait(num_threads, SpinYieldParkWaitPolicy(event_count));
+  }
+  // Teardown.
+  if (state.thread_index() == 0) {
+    state.SetItemsProcessed(state.iterations());
+    delete barrier;
+    delete event_count;
+  }
+}
+
+// =============================================================================
+// Benchmark: Barrier Synchronization Primitive, spinning or parking as learned
+// from the recent waits at this barrier instance.
+template <BarrierType barrier_type>
+void BM_BarrierWithAdaptiveWait(benchmark::State& state) {  // NOLINT
+  // Setup.
+  const auto& num_threads = state.threads();
+  static Barrier* barrier = nullptr;
+  static EventCount* event_count = nullptr;
+  static WaitEstimate* estimate = nullptr;
+  if (state.thread_index() == 0) {
+    event_count = new EventCount();
+    estimate = new WaitEstimate();
+    barrier = modcncy::Barrier::Create(barrier_type);
+    barrier->SetEventCount(event_count);
+  }
+  // Benchmark.
+  for (auto _ : state) {
+    barrier->Wait(num_threads, AdaptiveWaitPolicy(estimate, event_count));
+  }
+  // Teardown.
+  if (state.thread_index() == 0) {
+    state.SetItemsProcessed(state.iterations());
+    state.counters["expected_wait_ns"] = estimate->ExpectedNs();
+    delete barrier;
+    delete estimate;
+    delete event_count;
+  }
+}
+
+// =============================================================================
+// Benchmark: Barrier Synchronization Primitive, specialized at compile-time.
+template <typename BarrierT>
+void BM_TemplatedBarrier(benchmark::State& state) {  // NOLINT
+  // Setup.
+  const auto& num_threads = state.threads();
+  static BarrierT* barrier = nullptr;
+  if (state.thread_index() == 0) {
+    barrier = new BarrierT();
+  }
+  // Benchmark.
+  for (auto _ : state) {
+    barrier->Wait(num_threads);
+  }
+  // Teardown.
+  if (state.thread_index() == 0) {
+    state.SetItemsProcessed(state.iterations());
+    delete barrier;
+  }
+}
+
+// =============================================================================
+// Benchmark: All-reduce of a scalar with a shared atomic and two barriers.
+void BM_BarrierWithAtomicReduction(benchmark::State& state) {  // NOLINT
+  // Setup.
+  const auto& num_threads = state.threads();
+  static Barrier* barrier = nullptr;
+  static std::atomic<unsigned> sum{0};
+  if (state.thread_index() == 0) {
+    barrier = Barrier::Create(BarrierType::kCentralSenseCounterBarrier);
+  }
+  // Benchmark.
+  for (auto _ : state) {
+    sum.fetch_add(state.thread_index(), std::memory_order_relaxed);
+    barrier->Wait(num_threads);
+    benchmark::DoNotOptimize(sum.load(std::memory_order_relaxed));
+    barrier->Wait(num_threads);
+  }
+  // Teardown.
+  if (state.thread_index() == 0) {
+    state.SetItemsProcessed(state.iterations());
+    delete barrier;
+  }
+}
+
+// =============================================================================
+// Benchmark: All-reduce of a scalar fused with a single barrier.
+void BM_ReducingBarrier(benchmark::State& state) {  // NOLINT
+  // Setup.
+  const auto& num_threads = state.threads();
+  static ReducingBarrier<int>* barrier = nullptr;
+  if (state.thread_index() == 0) {
+    barrier = new ReducingBarrier<int>(num_threads);
+  }
+  // Benchmark.
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        barrier->Wait(state.thread_index(), state.thread_index()));
+  }
+  // Teardown.
+  if (state.thread_index() == 0) {
+    state.SetItemsProcessed(state.iterations());
+    delete barrier;
+  }
+}
+
+// =============================================================================
+// Benchmark: Barrier Synchronization Primitive, synchronizing phases of work.
+// Every thread works `work_ns` nanoseconds per phase, plus up to `imbalance`
+// percent more, drawn at random on every phase. Threads may be `pinned` to
+// CPUs, and wait with the applied `policy`.
+template <BarrierType barrier_type, void (*policy)(), bool pinned>
+void BM_BarrierPhase(benchmark::State& state) {  // NOLINT(runtime/references)
+  // Setup.
+  const auto& num_threads = state.threads();
+  const int64_t work_ns = state.range(0);
+  const int64_t imbalance = state.range(1);
+  static Barrier* barrier = nullptr;
+  if (state.thread_index() == 0) {
+    barrier = modcncy::Barrier::Create(barrier_type, num_threads);
+  }
+  if (pinned) PinAcrossNodesOrSkip(state);
+  std::minstd_rand rand_gen(state.thread_index() + 1);
+  std::uniform_int_distribution<int64_t> extra_work(0,
+                                                    work_ns * imbalance / 100);
+  const auto start = std::chrono::steady_clock::now();
+  const int64_t start_cpu_ns = ProcessCpuTimeNs();
+  // Benchmark.
+  for (auto _ : state) {
+    SyntheticWork(work_ns + extra_work(rand_gen));
+    barrier->Wait(num_threads, policy);
+  }
+  // Teardown.
+  const int64_t cpu_ns = ProcessCpuTimeNs() - start_cpu_ns;
+  const int64_t real_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                              std::chrono::steady_clock::now() - start)
+                              .count();
+  if (pinned) UnpinThread();
+  if (state.thread_index() == 0) {
+    state.SetItemsProcessed(state.iterations());
+    state.counters["ns/phase"] = static_cast<double>(real_ns) /
+                                 state.iterations();
+    state.counters["cpu_ns/phase"] = static_cast<double>(cpu_ns) /
+                                     state.iterations();
+    delete barrier;
+  }
+}
+
+// =============================================================================
+// Scenarios of the phase benchmarks: synthetic work per phase, imbalance
+// between threads, and up to twice as many threads as available cores. Besides
+// the real time per phase, the CPU time consumed by all threads per phase tells
+// spinning and sleeping waits apart.
+void PhaseScenarios(benchmark::internal::Benchmark* benchmark) {
+  const int num_cpus = std::thread::hardware_concurrency();
+  benchmark->ArgNames({"work_ns", "imbalance"});
+  for (int work_ns : {0, 1000, 10000})
+    for (int imbalance : {0, 50}) benchmark->Args({work_ns, imbalance});
+  benchmark->ThreadRange(1, num_cpus)
+      ->Threads(2 * num_cpus)
+      ->UseRealTime()
+      ->MeasureProcessCPUTime();
+}
+
 BENCHMARK_TEMPLATE(BM_Barrier, BarrierType::kCentralSenseCounterBarrier)
     ->ThreadRange(1, std::thread::hardware_concurrency())
     ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_TemplatedBarrier,
+                   CentralSenseCounterBarrierT<YieldWaitPolicy>)
+    ->ThreadRange(1, std::thread::hardware_concurrency())
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_BarrierWithPolicy,
+                   BarrierType::kCentralSenseCounterBarrier, &cpu_pause)
+    ->ThreadRange(1, std::thread::hardware_concurrency())
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_TemplatedBarrier,
+                   CentralSenseCounterBarrierT<PauseWaitPolicy>)
+    ->ThreadRange(1, std::thread::hardware_concurrency())
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_BarrierWithBackoff,
+                   BarrierType::kCentralSenseCounterBarrier)
+    ->ThreadRange(1, std::thread::hardware_concurrency())
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_BarrierWithMonitorWait,
+                   BarrierType::kCentralSenseCounterBarrier)
+    ->ThreadRange(1, std::thread::hardware_concurrency())
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_TemplatedBarrier,
+                   CentralSenseCounterBarrierT<MonitorWaitPolicy>)
+    ->ThreadRange(1, std::thread::hardware_concurrency())
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_TemplatedBarrier,
+                   CentralSenseCounterBarrierT<CalibratedPauseWaitPolicy>)
+    ->ThreadRange(1, std::thread::hardware_concurrency())
+    ->UseRealTime();
 BENCHMARK_TEMPLATE(BM_Barrier, BarrierType::kCentralStepCounterBarrier)
     ->ThreadRange(1, std::thread::hardware_concurrency())
     ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_TemplatedBarrier,
+                   CentralStepCounterBarrierT<YieldWaitPolicy>)
+    ->ThreadRange(1, std::thread::hardware_concurrency())
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_BarrierWithPolicy,
+                   BarrierType::kCentralStepCounterBarrier, &cpu_pause)
+    ->ThreadRange(1, std::thread::hardware_concurrency())
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_TemplatedBarrier,
+                   CentralStepCounterBarrierT<PauseWaitPolicy>)
+    ->ThreadRange(1, std::thread::hardware_concurrency())
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_BarrierWithBackoff,
+                   BarrierType::kCentralStepCounterBarrier)
+    ->ThreadRange(1, std::thread::hardware_concurrency())
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_BarrierWithMonitorWait,
+                   BarrierType::kCentralStepCounterBarrier)
+    ->ThreadRange(1, std::thread::hardware_concurrency())
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_TemplatedBarrier,
+                   CentralStepCounterBarrierT<MonitorWaitPolicy>)
+    ->ThreadRange(1, std::thread::hardware_concurrency())
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_TemplatedBarrier,
+                   CentralStepCounterBarrierT<CalibratedPauseWaitPolicy>)
+    ->ThreadRange(1, std::thread::hardware_concurrency())
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_BarrierWithParking,
+                   BarrierType::kCentralStepCounterBarrier)
+    ->ThreadRange(1, std::thread::hardware_concurrency())
+    ->Threads(2 * std::thread::hardware_concurrency())
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_BarrierWithAdaptiveWait,
+                   BarrierType::kCentralStepCounterBarrier)
+    ->ThreadRange(1, std::thread::hardware_concurrency())
+    ->Threads(2 * std::thread::hardware_concurrency())
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Barrier, BarrierType::kCombiningTreeBarrier)
+    ->ThreadRange(1, std::thread::hardware_concurrency())
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Barrier, BarrierType::kDisseminationBarrier)
+    ->ThreadRange(1, std::thread::hardware_concurrency())
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_BarrierWithThreadId, BarrierType::kDisseminationBarrier)
+    ->ThreadRange(1, std::thread::hardware_concurrency())
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Barrier, BarrierType::kTournamentBarrier)
+    ->ThreadRange(1, std::thread::hardware_concurrency())
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_BarrierWithThreadId, BarrierType::kTournamentBarrier)
+    ->ThreadRange(1, std::thread::hardware_concurrency())
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Barrier, BarrierType::kStaticTreeBarrier)
+    ->ThreadRange(1, std::thread::hardware_concurrency())
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_BarrierWithThreadId, BarrierType::kStaticTreeBarrier)
+    ->ThreadRange(1, std::thread::hardware_concurrency())
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Barrier, BarrierType::kSpinThenParkBarrier)
+    ->ThreadRange(1, std::thread::hardware_concurrency())
+    ->UseRealTime();
+BENCHMARK(BM_BarrierWithAtomicReduction)
+    ->ThreadRange(1, std::thread::hardware_concurrency())
+    ->UseRealTime();
+BENCHMARK(BM_ReducingBarrier)
+    ->ThreadRange(1, std::thread::hardware_concurrency())
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Barrier, BarrierType::kNumaHierarchicalBarrier)
+    ->ThreadRange(1, std::thread::hardware_concurrency())
+    ->UseRealTime();
+
+// Pinned scenarios, with threads spread across NUMA nodes.
+BENCHMARK_TEMPLATE(BM_BarrierPinnedAcrossNodes,
+                   BarrierType::kCentralSenseCounterBarrier)
+    ->ThreadRange(1, std::thread::hardware_concurrency())
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_BarrierPinnedAcrossNodes,
+                   BarrierType::kCombiningTreeBarrier)
+    ->ThreadRange(1, std::thread::hardware_concurrency())
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_BarrierPinnedAcrossNodes,
+                   BarrierType::kNumaHierarchicalBarrier)
+    ->ThreadRange(1, std::thread::hardware_concurrency())
+    ->UseRealTime();
+
+// Oversubscribed scenarios, with more threads than available cores.
+BENCHMARK_TEMPLATE(BM_Barrier, BarrierType::kCentralSenseCounterBarrier)
+    ->Threads(2 * std::thread::hardware_concurrency())
+    ->Threads(4 * std::thread::hardware_concurrency())
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Barrier, BarrierType::kCentralStepCounterBarrier)
+    ->Threads(2 * std::thread::hardware_concurrency())
+    ->Threads(4 * std::thread::hardware_concurrency())
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Barrier, BarrierType::kSpinThenParkBarrier)
+    ->Threads(2 * std::thread::hardware_concurrency())
+    ->Threads(4 * std::thread::hardware_concurrency())
+    ->UseRealTime();
+
+// Phase scenarios, with every wait policy, unpinned and pinned threads.
+BENCHMARK_TEMPLATE(BM_BarrierPhase, BarrierType::kCentralSenseCounterBarrier,
+                   &cpu_no_op, false)
+    ->Apply(PhaseScenarios);
+BENCHMARK_TEMPLATE(BM_BarrierPhase, BarrierType::kCentralSenseCounterBarrier,
+                   &cpu_yield, false)
+    ->Apply(PhaseScenarios);
+BENCHMARK_TEMPLATE(BM_BarrierPhase, BarrierType::kCentralSenseCounterBarrier,
+                   &cpu_pause, false)
+    ->Apply(PhaseScenarios);
+BENCHMARK_TEMPLATE(BM_BarrierPhase, BarrierType::kCentralSenseCounterBarrier,
+                   &cpu_pause, true)
+    ->Apply(PhaseScenarios);
+BENCHMARK_TEMPLATE(BM_BarrierPhase, BarrierType::kCombiningTreeBarrier,
+                   &cpu_no_op, false)
+    ->Apply(PhaseScenarios);
+BENCHMARK_TEMPLATE(BM_BarrierPhase, BarrierType::kCombiningTreeBarrier,
+                   &cpu_yield, false)
+    ->Apply(PhaseScenarios);
+BENCHMARK_TEMPLATE(BM_BarrierPhase, BarrierType::kCombiningTreeBarrier,
+                   &cpu_pause, false)
+    ->Apply(PhaseScenarios);
+BENCHMARK_TEMPLATE(BM_BarrierPhase, BarrierType::kCombiningTreeBarrier,
+                   &cpu_pause, true)
+    ->Apply(PhaseScenarios);
+BENCHMARK_TEMPLATE(BM_BarrierPhase, BarrierType::kSpinThenParkBarrier,
+                   &cpu_no_op, false)
+    ->Apply(PhaseScenarios);
+BENCHMARK_TEMPLATE(BM_BarrierPhase, BarrierType::kSpinThenParkBarrier,
+                   &cpu_yield, false)
+    ->Apply(PhaseScenarios);
+BENCHMARK_TEMPLATE(BM_BarrierPhase, BarrierType::kSpinThenParkBarrier,
+                   &cpu_pause, false)
+    ->Apply(PhaseScenarios);
+BENCHMARK_TEMPLATE(BM_BarrierPhase, BarrierType::kSpinThenParkBarrier,
+                   &cpu_pause, true)
+    ->Apply(PhaseScenarios);
+BENCHMARK_TEMPLATE(BM_BarrierPhase, BarrierType::kAdaptive, &cpu_yield, false)
+    ->Apply(PhaseScenarios);
 
 }  // namespace
 }  // namespace modcncy
@@ -0,0 +1,315 @@
+// Copyright 2022 The Modcncy Authors. All rights reserved.
+// Use of this source code is governed by the license found in the LICENSE file.
+// -----------------------------------------------------------------------------
+//
+// Wait policies benchmarks. A signaling thread (thread 0) keeps busy for a hold
+// time, and then signals a flag that the other threads wait for with the wait
+// policy under test:
+//
+//   + Ping-pong: A single waiting thread acknowledges every signal, and both
+//     threads are pinned to different CPUs. It is skipped on hosts that leave
+//     fewer than two CPUs to pin to.
+//
+//   + Broadcast: Many waiting threads are woken up by the same signal, and the
+//     signaling thread waits until all of them have acknowledged it.
+//
+// Each benchmark reports the distribution of the latency from a signal to the
+// wake-up of a waiting thread, and the CPU time consumed by the waiting threads
+// per microsecond they waited. Sweeping the hold time gives the tradeoff curve
+// between both for every policy.
+//
+// -----------------------------------------------------------------------------
+
+#include <benchmark/benchmark.h>
+#include <modcncy/global_expressions.h>
+#include <modcncy/templated_barrier.h>
+#include <modcncy/thread_affinity.h>
+#include <modcncy/wait_policy.h>
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT(build/c++11)
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace modcncy {
+namespace {
+
+// =============================================================================
+// Returns the current time of the steady clock, in nanoseconds.
+int64_t Now() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// =============================================================================
+// Returns the CPU time consumed so far by the calling thread, in nanoseconds.
+int64_t ThreadCpuTimeNs() {
+  rusage usage;
+  getrusage(RUSAGE_THREAD, &usage);
+  return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000000LL +
+         (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1000LL;
+}
+
+// =============================================================================
+// Keeps current thread busy for `duration_ns` nanoseconds.
+void SyntheticWork(int64_t duration_ns) {
+  const int64_t end = Now() + duration_ns;
+  while (Now() < end) {
+  }
+}
+
+// =============================================================================
+// Builds a fresh wait policy for every wait, parking on `event_count` and
+// learning in `estimate` if it does. Only parking policies need the signaling
+// thread to notify the event count.
+template <typename WaitPolicy>
+struct PolicyTraits {
+  static constexpr bool kNeedsNotification = false;
+  static WaitPolicy Make(EventCount* /*event_count*/,
+                         WaitEstimate* /*estimate*/) {
+    return WaitPolicy();
+  }
+};  // struct PolicyTraits
+
+template <>
+struct PolicyTraits<SpinYieldParkWaitPolicy> {
+  static constexpr bool kNeedsNotification = true;
+  static SpinYieldParkWaitPolicy Make(EventCount* event_count,
+                                      WaitEstimate* /*estimate*/) {
+    return SpinYieldParkWaitPolicy(event_count);
+  }
+};  // struct PolicyTraits
+
+template <>
+struct PolicyTraits<AdaptiveWaitPolicy> {
+  static constexpr bool kNeedsNotification = true;
+  static AdaptiveWaitPolicy Make(EventCount* event_count,
+                                 WaitEstimate* estimate) {
+    return AdaptiveWaitPolicy(estimate, event_count);
+  }
+};  // struct PolicyTraits
+
+// Flags shared by the signaling and the waiting threads.
+struct Channel {
+  // Number of signals so far, and the time of the last one.
+  alignas(kCacheLineSize) std::atomic<unsigned> signals{0};
+  std::atomic<int64_t> signal_ns{0};
+
+  // Number of acknowledgements so far.
+  alignas(kCacheLineSize) std::atomic<unsigned> acks{0};
+
+  // Event count notified on every signal and acknowledgement.
+  EventCount event_count;
+
+  // Recent waits for signals and for acknowledgements.
+  WaitEstimate signal_estimate;
+  WaitEstimate ack_estimate;
+};  // struct Channel
+
+// Measurements of a thread.
+struct ThreadResult {
+  // Latency from every signal to the wake-up of the thread.
+  std::vector<int64_t> latencies_ns;
+  // Time spent waiting for signals.
+  int64_t waited_ns = 0;
+  // CPU time consumed over the whole run.
+  int64_t cpu_ns = 0;
+};  // struct ThreadResult
+
+// =============================================================================
+// Waits with a fresh `WaitPolicy` until `flag` reaches `value`.
+template <typename WaitPolicy>
+void WaitFor(const std::atomic<unsigned>& flag, unsigned value,
+             EventCount* event_count, WaitEstimate* estimate) {
+  WaitPolicy policy = PolicyTraits<WaitPolicy>::Make(event_count, estimate);
+  WatchAddress(&policy, &flag);
+  while (flag.load(std::memory_order_acquire) != value) policy();
+}
+
+// =============================================================================
+// Notifies the threads waiting with a `WaitPolicy`, if they need it.
+template <typename WaitPolicy>
+void Notify(EventCount* event_count) {
+  if (PolicyTraits<WaitPolicy>::kNeedsNotification) event_count->NotifyAll();
+}
+
+// =============================================================================
+// Pins every thread to a CPU of its own, across NUMA nodes. Otherwise, skips
+// the run on all threads, which agree on it first, as a thread left running
+// would wait forever for a skipped one.
+bool PinToOwnCpusOrSkip(benchmark::State& state) {  // NOLINT
+  // Threads would share CPUs, which all of them see alike.
+  if (NumPinnableCpus() < state.threads()) {
+    state.SkipWithError("Fewer CPUs to pin to than threads.");
+    return false;
+  }
+  static CentralSenseCounterBarrierT<YieldWaitPolicy> setup_barrier;
+  static std::atomic<int> num_unpinned{0};
+  if (!PinThreadAcrossNodes(state.thread_index())) num_unpinned.fetch_add(1);
+  setup_barrier.Wait(state.threads());
+  const bool all_pinned = num_unpinned.load() == 0;
+  setup_barrier.Wait(state.threads());
+  if (state.thread_index() == 0) num_unpinned.store(0);
+  if (all_pinned) return true;
+  UnpinThread();
+  state.SkipWithError("Some thread could not be pinned.");
+  return false;
+}
+
+// =============================================================================
+// Returns the `quantile` of the sorted `values`.
+int64_t Percentile(const std::vector<int64_t>& values, double quantile) {
+  if (values.empty()) return 0;
+  return values[static_cast<size_t>(quantile * (values.size() - 1))];
+}
+
+// =============================================================================
+// Runs the signaling thread or a waiting thread, holding the CPU for the
+// nanoseconds given as first argument before every signal.
+template <typename WaitPolicy>
+void RunWakeUps(benchmark::State& state, bool pinned) {  // NOLINT
+  // Setup.
+  const int num_threads = state.threads();
+  const int thread_index = state.thread_index();
+  const int num_waiters = num_threads - 1;
+  const int64_t hold_ns = state.range(0);
+  if (pinned && !PinToOwnCpusOrSkip(state)) return;
+  static Channel channel;
+  static std::vector<ThreadResult>* results = nullptr;
+  static std::atomic<int> num_done{0};
+  if (thread_index == 0) {
+    channel.signals.store(0);
+    channel.acks.store(0);
+    channel.signal_estimate.Reset();
+    channel.ack_estimate.Reset();
+    results = new std::vector<ThreadResult>(num_threads);
+    num_done.store(0);
+  }
+  ThreadResult result;
+  result.latencies_ns.reserve(state.max_iterations);
+  unsigned round = 0;
+  const int64_t cpu_start_ns = ThreadCpuTimeNs();
+
+  // Benchmark.
+  for (auto _ : state) {
+    ++round;
+    if (thread_index == 0) {
+      // Signal all waiting threads after the hold time, and wait until all of
+      // them acknowledge the signal.
+      SyntheticWork(hold_ns);
+      channel.signal_ns.store(Now(), std::memory_order_relaxed);
+      channel.signals.store(round, std::memory_order_release);
+      Notify<WaitPolicy>(&channel.event_count);
+      WaitFor<WaitPolicy>(channel.acks, round * num_waiters,
+                          &channel.event_count, &channel.ack_estimate);
+    } else {
+      // Wait for the signal and acknowledge it.
+      const int64_t wait_start_ns = Now();
+      WaitFor<WaitPolicy>(channel.signals, round, &channel.event_count,
+                          &channel.signal_estimate);
+      const int64_t wake_ns = Now();
+      result.latencies_ns.push_back(
+          wake_ns - channel.signal_ns.load(std::memory_order_relaxed));
+      result.waited_ns += wake_ns - wait_start_ns;
+      channel.acks.fetch_add(1, std::memory_order_release);
+      Notify<WaitPolicy>(&channel.event_count);
+    }
+  }
+
+  // Teardown.
+  result.cpu_ns = ThreadCpuTimeNs() - cpu_start_ns;
+  if (pinned) UnpinThread();
+  (*results)[thread_index] = std::move(result);
+  num_done.fetch_add(1, std::memory_order_acq_rel);
+  if (thread_index == 0) {
+    while (num_done.load(std::memory_order_acquire) != num_threads)
+      cpu_yield();
+    std::vector<int64_t> latencies_ns;
+    int64_t waited_ns = 0;
+    int64_t cpu_ns = 0;
+    for (int i = 1; i < num_threads; ++i) {
+      const ThreadResult& waiter = (*results)[i];
+      latencies_ns.insert(latencies_ns.end(), waiter.latencies_ns.begin(),
+                          waiter.latencies_ns.end());
+      waited_ns += waiter.waited_ns;
+      cpu_ns += waiter.cpu_ns;
+    }
+    std::sort(latencies_ns.begin(), latencies_ns.end());
+    state.SetItemsProcessed(state.iterations());
+    state.counters["wake_p50_ns"] = Percentile(latencies_ns, 0.50);
+    state.counters["wake_p90_ns"] = Percentile(latencies_ns, 0.90);
+    state.counters["wake_p99_ns"] = Percentile(latencies_ns, 0.99);
+    state.counters["wake_max_ns"] = Percentile(latencies_ns, 1.00);
+    // A waiting thread burning a whole CPU consumes 1 us per us waited.
+    state.counters["cpu_us_per_us_waited"] =
+        waited_ns > 0 ? static_cast<double>(cpu_ns) / waited_ns : 0.0;
+    delete results;
+  }
+}
+
+// =============================================================================
+// Benchmark: Ping-pong between two threads pinned to different CPUs.
+template <typename WaitPolicy>
+void BM_PingPong(benchmark::State& state) {  // NOLINT(runtime/references)
+  RunWakeUps<WaitPolicy>(state, /*pinned=*/true);
+}
+
+// =============================================================================
+// Benchmark: Broadcast wake-up of many threads by a single one.
+template <typename WaitPolicy>
+void BM_Broadcast(benchmark::State& state) {  // NOLINT(runtime/references)
+  RunWakeUps<WaitPolicy>(state, /*pinned=*/false);
+}
+
+// =============================================================================
+// Hold times, from back-to-back signals to long phases.
+void HoldTimes(benchmark::internal::Benchmark* benchmark) {
+  benchmark->ArgName("hold_ns");
+  for (int64_t hold_ns : {0, 1000, 10000, 100000}) benchmark->Arg(hold_ns);
+  benchmark->UseRealTime();
+}
+
+void PingPongScenarios(benchmark::internal::Benchmark* benchmark) {
+  HoldTimes(benchmark);
+  benchmark->Threads(2);
+}
+
+void BroadcastScenarios(benchmark::internal::Benchmark* benchmark) {
+  HoldTimes(benchmark);
+  benchmark->Threads(4)->Threads(8);
+}
+
+}  // namespace
+
+// Register benchmarks.
+BENCHMARK_TEMPLATE(BM_PingPong, NoOpWaitPolicy)->Apply(PingPongScenarios);
+BENCHMARK_TEMPLATE(BM_PingPong, YieldWaitPolicy)->Apply(PingPongScenarios);
+BENCHMARK_TEMPLATE(BM_PingPong, PauseWaitPolicy)->Apply(PingPongScenarios);
+BENCHMARK_TEMPLATE(BM_PingPong, CalibratedPauseWaitPolicy)
+    ->Apply(PingPongScenarios);
+BENCHMARK_TEMPLATE(BM_PingPong, ExponentialBackoffWaitPolicy)
+    ->Apply(PingPongScenarios);
+BENCHMARK_TEMPLATE(BM_PingPong, SpinYieldParkWaitPolicy)
+    ->Apply(PingPongScenarios);
+BENCHMARK_TEMPLATE(BM_PingPong, AdaptiveWaitPolicy)->Apply(PingPongScenarios);
+BENCHMARK_TEMPLATE(BM_PingPong, MonitorWaitPolicy)->Apply(PingPongScenarios);
+BENCHMARK_TEMPLATE(BM_Broadcast, NoOpWaitPolicy)->Apply(BroadcastScenarios);
+BENCHMARK_TEMPLATE(BM_Broadcast, YieldWaitPolicy)->Apply(BroadcastScenarios);
+BENCHMARK_TEMPLATE(BM_Broadcast, PauseWaitPolicy)->Apply(BroadcastScenarios);
+BENCHMARK_TEMPLATE(BM_Broadcast, CalibratedPauseWaitPolicy)
+    ->Apply(BroadcastScenarios);
+BENCHMARK_TEMPLATE(BM_Broadcast, ExponentialBackoffWaitPolicy)
+    ->Apply(BroadcastScenarios);
+BENCHMARK_TEMPLATE(BM_Broadcast, SpinYieldParkWaitPolicy)
+    ->Apply(BroadcastScenarios);
+BENCHMARK_TEMPLATE(BM_Broadcast, AdaptiveWaitPolicy)
+    ->Apply(BroadcastScenarios);
+BENCHMARK_TEMPLATE(BM_Broadcast, MonitorWaitPolicy)->Apply(BroadcastScenarios);
+
+}  // namespace modcncy
+
+BENCHMARK_MAIN();
@@ -14,6 +14,27 @@
 //   + `Wait()` must guarantee to stop the execution of a thread until all other
 //     threads reach this same point.
 //
+//   + `Wait()` with a `thread_id` may rely on the identity of the calling thread
+//     to keep per-thread state. By default, the identity is ignored.
+//
+//   + `Arrive()` and `Wait()` with a `Token` split a barrier synchronization in
+//     two phases, so a thread can do independent work in between. `Arrive()`
+//     signals the arrival of the calling thread without blocking it, and
+//     `Wait()` blocks until the synchronization identified by the returned
+//     token completes. By default, `Arrive()` blocks as `Wait()` does, with
+//     the default policy, and waiting on its token returns right away. The
+//     dissemination, tournament and static tree barriers keep that default,
+//     while all barriers that `kAdaptive` may select split the synchronization.
+//
+//   + A completion function, if set, must be run exactly once per barrier
+//     synchronization by a thread that knows all threads have arrived, before
+//     any of them is released. Every barrier supports it. The dissemination
+//     barrier, where no thread plays that role, pays an extra pass for it.
+//
+//   + An event count, if set, must be notified after every signal a thread at
+//     the barrier sends to another one, so threads waiting with a parking
+//     policy on it, such as `SpinYieldParkWaitPolicy`, are woken up.
+//
 // TODO(arturogr-dev): Add usage example.
 //
 // -----------------------------------------------------------------------------
@@ -31,13 +52,30 @@ namespace modcncy {
 enum class BarrierType {
   kCentralSenseCounterBarrier = 0,  // Central Sense and Central Counter Barrier
   kCentralStepCounterBarrier = 1,   // Central Step and Central Counter Barrier
+  kCombiningTreeBarrier = 2,        // Software Combining Tree Barrier
+  kDisseminationBarrier = 3,        // Dissemination Barrier
+  kTournamentBarrier = 4,           // Tournament Barrier (MCS)
+  kStaticTreeBarrier = 5,           // Static Tree Barrier (MCS)
+  kSpinThenParkBarrier = 6,         // Central Step Barrier parking on a futex
+  kAdaptive = 7,                    // Selected from threads and CPU topology
+  kNumaHierarchicalBarrier = 8,     // Per-NUMA node and then global barrier
 };
 
 // Barrier base interface.
 class Barrier {
  public:
+  // Identifies the barrier synchronization a thread arrived at.
+  struct Token {
+    unsigned phase;
+    // Part played by the thread in it, private to each barrier.
+    unsigned role;
+  };  // struct Token
+
   // Factory method. Creates a new `Barrier` object.
-  static Barrier* Create(BarrierType type);
+  // The expected number of participants, `num_threads`, tells `kAdaptive`
+  // which barrier to select. If it is not positive, all online CPUs are
+  // expected to take part.
+  static Barrier* Create(BarrierType type, int num_threads = 0);
 
   virtual ~Barrier() {}
 
@@ -45,6 +83,50 @@ class Barrier {
   // All threads at the barrier wait with the applied `policy`.
   virtual void Wait(int num_threads,
                     std::function<void()> policy = &cpu_yield) = 0;
+
+  // Blocks current thread until the last of `num_threads` reaches this point.
+  // The calling thread is identified by a unique `thread_id` in the range
+  // [0, num_threads). All threads at the barrier wait with the applied `policy`.
+  virtual void Wait(int num_threads, int thread_id,
+                    std::function<void()> policy = &cpu_yield);
+
+  // Signals that current thread, one of `num_threads`, reached this point.
+  // Returns the token to `Wait()` on for the current barrier synchronization.
+  virtual Token Arrive(int num_threads);
+
+  // Blocks current thread until the barrier synchronization identified by
+  // `token` completes. The thread waits with the applied `policy`.
+  virtual void Wait(Token token, std::function<void()> policy = &cpu_yield);
+
+  // Sets the `completion` function to be run once per barrier synchronization
+  // by the last arriving thread, while all other threads are still waiting.
+  // It must not be set while any thread is at the barrier.
+  virtual void SetCompletion(std::function<void()> completion);
+
+  // Sets the `event_count` to be notified every time a thread at the barrier
+  // signals another one. It must not be set while any thread is at the barrier.
+  virtual void SetEventCount(EventCount* event_count);
+
+ protected:
+  // Returns whether a completion function is set.
+  bool HasCompletion() const { return static_cast<bool>(completion_); }
+
+  // Runs the completion function, if any.
+  void Complete() {
+    if (completion_) completion_();
+  }
+
+  // Notifies the event count, if any.
+  void Notify() {
+    if (event_count_ != nullptr) event_count_->NotifyAll();
+  }
+
+ private:
+  // Function run by the last arriving thread.
+  std::function<void()> completion_;
+
+  // Event count notified on every signal.
+  EventCount* event_count_ = nullptr;
 };  // class Barrier
 
 }  // namespace modcncy
@@ -2,7 +2,9 @@
 // Use of this source code is governed by the license found in the LICENSE file.
 // -----------------------------------------------------------------------------
 //
-// A concurrent task queue is a thread-safe FIFO container of tasks.
+// A concurrent task queue is a thread-safe container of tasks, FIFO unless
+// stated otherwise. Tasks are stored by value, so any task fitting a `Task<>`
+// is queued without allocating it on the heap.
 //
 // A factory is in charge of instantiating any of the different supported
 // concurrent task queue implementations during runtime.
@@ -13,6 +15,29 @@
 //
 //   + `Pop()` removes a task from the queue.
 //
+//   + `Steal()` removes a task from the queue on behalf of a thread other than
+//     its owner. It is the same as `Pop()` unless the queue has an owner.
+//
+//   + `PushBulk()`, `PopBatch()` and `StealBatch()` do the same for many tasks
+//     at once. By default, they loop over the single-task versions, and queues
+//     override them to pay for synchronization once per batch instead.
+//
+// Thieves call `StealHalf()` on their own queue to move up to half the tasks of
+// a victim into it, so they steal less often than taking one task at a time.
+// The blocking queue, the bounded lock-free queue and the work-stealing deque
+// steal in batches. The unbounded lock-free queue cannot tell how many tasks it
+// holds without a count shared by all its producers and consumers, so thieves
+// still take one task at a time from it.
+//
+// Bounded queues hold up to a capacity given at creation. Pushing into a full
+// bounded queue waits until another thread pops a task, so callers must size
+// them for the tasks they keep pending at once.
+//
+// Unbounded queues grow as needed, and ignore the capacity given at creation.
+//
+// Work-stealing deques have an owner thread, the only one allowed to push and
+// pop, which it does in LIFO order. Other threads steal the oldest tasks.
+//
 // TODO(arturogr-dev): Add usage example.
 //
 // -----------------------------------------------------------------------------
@@ -20,28 +45,64 @@
 #ifndef MODCNCY_INCLUDE_MODCNCY_CONCURRENT_TASK_QUEUE_H_
 #define MODCNCY_INCLUDE_MODCNCY_CONCURRENT_TASK_QUEUE_H_
 
-#include <functional>
+#include <cstddef>
+
+#include "modcncy/task.h"
 
 namespace modcncy {
 
 // Supported concurrent task queues.
 enum class ConcurrentTaskQueueType {
-  kBlockingTaskQueue = 0,  // Concurrent blocking queue of tasks.
+  kBlockingTaskQueue = 0,           // Concurrent blocking queue of tasks.
+  kBoundedLockFreeTaskQueue = 1,    // Bounded lock-free ring queue of tasks.
+  kWorkStealingTaskDeque = 2,       // Chase-Lev work-stealing deque of tasks.
+  kUnboundedLockFreeTaskQueue = 3,  // Michael-Scott lock-free queue of tasks.
 };
 
 // Concurrent task queue base interface.
 class ConcurrentTaskQueue {
  public:
-  // Factory method. Creates a new `Barrier` object.
-  static ConcurrentTaskQueue* Create(ConcurrentTaskQueueType type);
+  // Default capacity of bounded queues.
+  static constexpr size_t kDefaultCapacity = 1024;
+
+  // Maximum number of tasks moved by `StealHalf()`.
+  static constexpr size_t kMaxStealBatch = 32;
+
+  // Factory method. Creates a new `ConcurrentTaskQueue` object. Bounded queues
+  // hold up to `capacity` tasks, rounded up to a power of two. Work-stealing
+  // deques start with room for that many tasks, and grow as needed.
+  static ConcurrentTaskQueue* Create(ConcurrentTaskQueueType type,
+                                     size_t capacity = kDefaultCapacity);
 
   virtual ~ConcurrentTaskQueue() {}
 
   // Inserts a task into the queue.
-  virtual void Push(std::function<void()> task) = 0;
+  virtual void Push(Task<> task) = 0;
 
   // Removes a task from the queue.
-  virtual std::function<void()> Pop() = 0;
+  virtual Task<> Pop() = 0;
+
+  // Removes a task from the queue on behalf of a thread other than its owner.
+  virtual Task<> Steal() { return Pop(); }
+
+  // Inserts the tasks from `first` to `last`, in order, moving them.
+  virtual void PushBulk(Task<>* first, Task<>* last);
+
+  // Removes up to `max_tasks` tasks from the queue, moving them into `tasks`.
+  // Returns the number of tasks removed.
+  virtual size_t PopBatch(Task<>* tasks, size_t max_tasks);
+
+  // Removes up to `max_tasks` tasks, and no more than half of them rounded up,
+  // on behalf of a thread other than its owner, moving them into `tasks`.
+  // Returns the number of tasks removed. Queues unable to tell how many tasks
+  // they hold remove one task at most.
+  virtual size_t StealBatch(Task<>* tasks, size_t max_tasks);
+
+  // Moves up to half the tasks of `victim`, rounded up and at most
+  // `kMaxStealBatch`, into this queue, or a single task if `victim` steals one
+  // task at most. Called by the owner of this queue. Returns the number of
+  // tasks moved.
+  size_t StealHalf(ConcurrentTaskQueue* victim);
 };  // class ConcurrentTaskQueue
 
 }  // namespace modcncy
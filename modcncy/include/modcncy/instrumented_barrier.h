@@ -0,0 +1,244 @@
+// Copyright 2022 The Modcncy Authors. All rights reserved.
+// Use of this source code is governed by the license found in the LICENSE file.
+// -----------------------------------------------------------------------------
+//
+// An `InstrumentedBarrier` wraps any other `Barrier` to measure how long
+// threads wait at it, and how unbalanced the work between two barrier
+// synchronizations is. It is opt-in: the barriers created by the factory are
+// not instrumented. Its behavior is summarized as follows:
+//
+//   1. When a thread arrives at the barrier, it reads the steady clock, keeps
+//      its arrival timestamp in its own slot, and folds it into the first and
+//      last arrivals of the current barrier synchronization (phase).
+//
+//   2. The thread completing the count of arrivals of the phase records its
+//      skew, the last minus the first arrival, and resets the phase before
+//      entering the wrapped barrier. No thread can arrive at the next phase
+//      until the wrapped barrier releases this one.
+//
+//   3. Every thread counts the iterations of the wait policy while it waits in
+//      the wrapped barrier, and records the time from its arrival to its
+//      release.
+//
+//   4. On its next arrival, a thread adds its lateness in the previous phase,
+//      its arrival minus the first one, to its slot. Slots are indexed by a
+//      number unique among the live threads, and numbers of exited threads are
+//      reused, so threads started for every run of an algorithm share them.
+//
+// Skews and wait times are kept in histograms of logarithmic buckets, with four
+// sub-buckets per power of two, from which `Snapshot()` estimates percentiles.
+// The skews of the first phases are also kept in order, so callers knowing the
+// structure of their algorithm can map phases back to their stages.
+//
+// Example:
+//
+//   modcncy::InstrumentedBarrier barrier(
+//       modcncy::Barrier::Create(modcncy::BarrierType::kAdaptive));
+//   ...
+//   barrier.Wait(num_threads);  // From every thread.
+//   ...
+//   const modcncy::BarrierStats stats = barrier.Snapshot();
+//   printf("p99 skew: %lld ns\n", static_cast<long long>(stats.skew.p99_ns));
+//
+// -----------------------------------------------------------------------------
+
+#ifndef MODCNCY_INCLUDE_MODCNCY_INSTRUMENTED_BARRIER_H_
+#define MODCNCY_INCLUDE_MODCNCY_INSTRUMENTED_BARRIER_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "modcncy/barrier.h"
+#include "modcncy/global_expressions.h"
+
+namespace modcncy {
+
+// Summary of a distribution of durations, in nanoseconds. Percentiles are
+// estimated from the histogram buckets, while the maximum is exact.
+struct DurationSummary {
+  uint64_t count = 0;
+  int64_t mean_ns = 0;
+  int64_t p50_ns = 0;
+  int64_t p90_ns = 0;
+  int64_t p99_ns = 0;
+  int64_t max_ns = 0;
+};  // struct DurationSummary
+
+// Summary of the lateness of a thread, its arrival minus the first arrival of
+// each barrier synchronization it took part in, in nanoseconds.
+struct LatenessSummary {
+  uint64_t count = 0;
+  int64_t mean_ns = 0;
+  int64_t max_ns = 0;
+};  // struct LatenessSummary
+
+// Statistics collected by an `InstrumentedBarrier`.
+struct BarrierStats {
+  // Number of barrier synchronizations completed.
+  uint64_t num_phases = 0;
+  // Last minus first arrival of each barrier synchronization.
+  DurationSummary skew;
+  // Time from the arrival of a thread to its release.
+  DurationSummary wait;
+  // Number of iterations of the wait policy, over all threads.
+  uint64_t num_spins = 0;
+  // Skew of each of the first barrier synchronizations, in nanoseconds.
+  std::vector<int64_t> phase_skews_ns;
+  // Lateness of each thread, indexed by its slot.
+  std::vector<LatenessSummary> thread_lateness;
+};  // struct BarrierStats
+
+class InstrumentedBarrier : public Barrier {
+ public:
+  // Maximum number of phases whose skew is kept in order.
+  static constexpr int kMaxRecordedPhases = 1 << 20;
+
+  // Maximum number of threads whose lateness is kept.
+  static constexpr int kMaxThreadSlots = 256;
+
+  // Wraps `barrier`, taking ownership of it.
+  explicit InstrumentedBarrier(Barrier* barrier);
+
+  InstrumentedBarrier(const InstrumentedBarrier&) = delete;
+  InstrumentedBarrier& operator=(const InstrumentedBarrier&) = delete;
+
+  ~InstrumentedBarrier() override;
+
+  // A thread must wait here until all threads reach this point.
+  void Wait(int num_threads, std::function<void()> policy = &cpu_yield) override;
+
+  // A thread must wait here until all threads reach this point.
+  void Wait(int num_threads, int thread_id,
+            std::function<void()> policy = &cpu_yield) override;
+
+  // A thread signals its arrival without waiting for all other threads.
+  Token Arrive(int num_threads) override;
+
+  // A thread must wait here until all threads arrive at the `token` phase.
+  // The wait time is measured from the call to this function.
+  void Wait(Token token, std::function<void()> policy = &cpu_yield) override;
+
+  // The wrapped barrier runs the `completion` function. Without one, it runs
+  // as it would unwrapped, as some barriers pay extra to run a completion.
+  void SetCompletion(std::function<void()> completion) override;
+
+  // The wrapped barrier notifies the `event_count`.
+  void SetEventCount(EventCount* event_count) override;
+
+  // Returns the statistics collected so far. It must not be called while any
+  // thread is at the barrier.
+  BarrierStats Snapshot() const;
+
+  // Discards the statistics collected so far. It must not be called while any
+  // thread is at the barrier.
+  void Reset();
+
+ private:
+  // Number of buckets of a histogram.
+  static constexpr int kNumBuckets = 256;
+
+  // Histogram of durations, in nanoseconds.
+  struct Histogram {
+    std::atomic<uint64_t> buckets[kNumBuckets];
+    std::atomic<uint64_t> count;
+    std::atomic<int64_t> sum;
+    std::atomic<int64_t> max;
+  };  // struct Histogram
+
+  // Per-thread arrivals and lateness. Only written by the thread holding it,
+  // and read by `Snapshot()`.
+  struct ThreadSlot {
+    // Last arrival not accounted for yet, and the number of phases completed
+    // before it plus one, or zero if there is none.
+    int64_t arrival;
+    uint64_t phase;
+    // Lateness accounted for so far.
+    uint64_t count;
+    int64_t sum_ns;
+    int64_t max_ns;
+    // Padding to prevent false sharing.
+    char padding[kCacheLineSize - 5 * sizeof(int64_t)];
+  };  // struct ThreadSlot
+
+  // Wait policy counting its iterations in `num_spins`. It only holds
+  // pointers, so wrapping it in a `std::function` does not allocate.
+  struct CountingPolicy {
+    void operator()() const {
+      ++*num_spins;
+      (*policy)();
+    }
+    std::function<void()>* policy;
+    uint64_t* num_spins;
+  };  // struct CountingPolicy
+
+  // Signals the arrival of current thread, recording the skew of the phase if
+  // it is the last of `num_threads` to arrive. Returns the arrival timestamp.
+  int64_t RecordArrival(int num_threads);
+
+  // Returns the lateness in `slot`, including its last arrival if it belongs
+  // to the last completed phase.
+  LatenessSummary LatenessOf(const ThreadSlot& slot) const;
+
+  // Records the wait of a thread from `arrival` on, spinning `num_spins` times.
+  void RecordWait(int64_t arrival, uint64_t num_spins);
+
+  // Records a `duration` in `histogram`.
+  static void Record(Histogram* histogram, int64_t duration);
+
+  // Returns the summary of `histogram`.
+  static DurationSummary Summarize(const Histogram& histogram);
+
+  // Clears `histogram`.
+  static void Clear(Histogram* histogram);
+
+  // Wrapped barrier.
+  Barrier* const barrier_;
+
+  // Histograms of phase skews and thread waits.
+  Histogram skews_;
+  Histogram waits_;
+
+  // Number of iterations of the wait policy, over all threads.
+  std::atomic<uint64_t> num_spins_{0};
+
+  // Skews of the first phases. Only written by the last arriving thread.
+  std::vector<int64_t> phase_skews_;
+
+  // Per-thread slots.
+  ThreadSlot thread_slots_[kMaxThreadSlots];
+
+  // Number of phases completed so far, and first arrival of the last one. Only
+  // written by the last arriving thread.
+  uint64_t num_completed_phases_ = 0;
+  int64_t last_first_arrival_ = 0;
+
+  // Padding to prevent false sharing.
+  char padding_[kCacheLineSize];
+
+  // Number of threads arrived at the current phase.
+  std::atomic<int> phase_arrivals_{0};
+
+  // First and last arrival timestamps of the current phase.
+  std::atomic<int64_t> first_arrival_;
+  std::atomic<int64_t> last_arrival_;
+};  // class InstrumentedBarrier
+
+// Formats the imbalance recorded in `stats` under a `title`: the percentiles of
+// the skew, the mean and maximum skew of each of the `num_stages` stages that
+// an algorithm goes through, in order, on every run, and the lateness of each
+// thread.
+std::string ImbalanceReport(const std::string& title, const BarrierStats& stats,
+                            size_t num_stages);
+
+// Imbalance reports by title, for callers collecting them over many runs, such
+// as benchmarks printing them once all of them ran.
+std::map<std::string, std::string>& ImbalanceReports();
+
+}  // namespace modcncy
+
+#endif  // MODCNCY_INCLUDE_MODCNCY_INSTRUMENTED_BARRIER_H_
@@ -0,0 +1,82 @@
+// Copyright 2022 The Modcncy Authors. All rights reserved.
+// Use of this source code is governed by the license found in the LICENSE file.
+// -----------------------------------------------------------------------------
+//
+// A Phaser is a reusable barrier whose set of participants may change from one
+// barrier synchronization (phase) to the next. Unlike `Barrier`, the number of
+// participants is tracked by the phaser itself, so threads do not need to agree
+// on it in every call. Its behavior is summarized as follows:
+//
+//   1. A thread becomes a participant with `Register()`. If a phase is already
+//      in progress, the phase also waits for the new participant.
+//
+//   2. A participant arrives at the phaser with `Wait()`, and waits there until
+//      all participants of the current phase arrive.
+//
+//   3. A participant leaves the phaser with `ArriveAndDeregister()`. It counts
+//      as arrived for the current phase and does not wait for it, and later
+//      phases no longer wait for it.
+//
+// The phase number, the number of participants and the number of participants
+// yet to arrive share a single atomic word, so every arrival, registration and
+// phase advance is a single atomic update. Thus, a phaser holds at most
+// `kMaxParticipants` participants. Registering more of them, or deregistering
+// one from a phaser without any, is a programming error caught by an assertion.
+//
+// Example:
+//
+//   modcncy::Phaser phaser(num_threads);
+//   ...
+//   // From every thread.
+//   while (HasWork()) {
+//     DoWork();
+//     phaser.Wait();
+//   }
+//   phaser.ArriveAndDeregister();
+//
+// -----------------------------------------------------------------------------
+
+#ifndef MODCNCY_INCLUDE_MODCNCY_PHASER_H_
+#define MODCNCY_INCLUDE_MODCNCY_PHASER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+
+#include "modcncy/wait_policy.h"
+
+namespace modcncy {
+
+class Phaser {
+ public:
+  // Maximum number of participants, limited by their 16-bit fields.
+  static constexpr int kMaxParticipants = 0xFFFF;
+
+  // Creates a phaser with `num_participants` already registered.
+  explicit Phaser(int num_participants = 0);
+
+  // Registers a new participant. Returns the phase the participant joined.
+  unsigned Register();
+
+  // Blocks current participant until all participants reach this point.
+  // Returns the phase that was completed. All participants at the phaser wait
+  // with the applied `policy`.
+  unsigned Wait(std::function<void()> policy = &cpu_yield);
+
+  // Signals the arrival of the current participant, without waiting for the
+  // others, and deregisters it. Returns the phase it arrived at.
+  unsigned ArriveAndDeregister();
+
+ private:
+  // Arrives at the current phase, leaving the phaser if `deregister` is set.
+  // Returns the state of the phaser right before the arrival.
+  uint64_t Arrive(bool deregister);
+
+  // Phase number (upper 32 bits), number of participants (middle 16 bits) and
+  // number of participants yet to arrive (lower 16 bits).
+  std::atomic<uint64_t> state_;
+};  // class Phaser
+
+}  // namespace modcncy
+
+#endif  // MODCNCY_INCLUDE_MODCNCY_PHASER_H_
@@ -0,0 +1,145 @@
+// Copyright 2022 The Modcncy Authors. All rights reserved.
+// Use of this source code is governed by the license found in the LICENSE file.
+// -----------------------------------------------------------------------------
+//
+// A `ReducingBarrier` fuses a barrier synchronization with an all-reduce: every
+// thread brings its own contribution to the barrier, and every thread leaves it
+// with the reduction of all contributions. Its behavior is summarized as
+// follows:
+//
+//   1. Each thread owns a node of a 4-ary tree. When a thread arrives at the
+//      barrier, it waits until the children of its node have arrived, combines
+//      their partial results with its own contribution, publishes it in its
+//      node and signals its parent.
+//
+//   2. When the root thread (identity 0) has heard from all its children, it
+//      holds the reduction of all contributions. It publishes it and releases
+//      all threads at once by increasing the current step.
+//
+// The reduction operation `Op` must be associative and commutative, since the
+// contributions are combined in tree order.
+//
+// Example:
+//
+//   modcncy::ReducingBarrier<int> barrier(num_threads);
+//   ...
+//   // From every thread.
+//   const int total_count = barrier.Wait(thread_id, my_count);
+//
+// -----------------------------------------------------------------------------
+
+#ifndef MODCNCY_INCLUDE_MODCNCY_REDUCING_BARRIER_H_
+#define MODCNCY_INCLUDE_MODCNCY_REDUCING_BARRIER_H_
+
+#include <stdlib.h>
+
+#include <atomic>
+#include <functional>
+#include <new>
+#include <utility>
+
+#include "modcncy/global_expressions.h"
+#include "modcncy/wait_policy.h"
+
+namespace modcncy {
+
+template <typename T, typename Op = std::plus<T>,
+          typename WaitPolicy = YieldWaitPolicy>
+class ReducingBarrier {
+ public:
+  // Creates a barrier for `num_threads` threads with identities in the range
+  // [0, num_threads), reducing their contributions with `op`.
+  explicit ReducingBarrier(int num_threads, Op op = Op())
+      : num_threads_(num_threads), op_(std::move(op)) {
+    void* memory = nullptr;
+    if (posix_memalign(&memory, kCacheLineSize, num_threads * sizeof(Node)))
+      throw std::bad_alloc();
+    nodes_ = static_cast<Node*>(memory);
+    for (int i = 0; i < num_threads; ++i) new (&nodes_[i]) Node();
+  }
+
+  ReducingBarrier(const ReducingBarrier&) = delete;
+  ReducingBarrier& operator=(const ReducingBarrier&) = delete;
+
+  ~ReducingBarrier() {
+    for (int i = 0; i < num_threads_; ++i) nodes_[i].~Node();
+    free(nodes_);
+  }
+
+  // A thread must wait here until all threads reach this point. The calling
+  // thread is identified by `thread_id` and contributes `value`. Returns the
+  // reduction of the contributions of all threads.
+  T Wait(int thread_id, T value, WaitPolicy policy = WaitPolicy()) {
+    const unsigned current_step = step_.load(std::memory_order_relaxed);
+    Node& my_node = nodes_[thread_id];
+
+    // Wait for my children and combine their partial results.
+    int first_child = kFanIn * thread_id + 1;
+    int last_child = first_child + kFanIn;
+    if (last_child > num_threads_) last_child = num_threads_;
+    if (first_child < last_child) {
+      my_node.awaited_arrivals += last_child - first_child;
+      WatchAddress(&policy, &my_node.arrivals);
+      while (static_cast<int>(
+                 my_node.arrivals.load(std::memory_order_acquire) -
+                 my_node.awaited_arrivals) < 0)
+        policy();
+      for (int child = first_child; child < last_child; ++child)
+        value = op_(value, nodes_[child].value);
+    }
+
+    if (thread_id == 0) {
+      // Root thread holds the reduction.
+      // Publish it and increase the step to release all spinning threads.
+      result_ = value;
+      step_.store(current_step + 1, std::memory_order_release);
+      return value;
+    }
+
+    // Publish my partial result, signal my parent and wait until the root
+    // releases all threads.
+    my_node.value = std::move(value);
+    nodes_[(thread_id - 1) / kFanIn].arrivals.fetch_add(
+        1, std::memory_order_release);
+    WatchAddress(&policy, &step_);
+    while (step_.load(std::memory_order_acquire) == current_step) policy();
+    return result_;
+  }
+
+ private:
+  // Number of children of a node in the tree.
+  static constexpr int kFanIn = 4;
+
+  // Per-thread node.
+  struct alignas(kCacheLineSize) Node {
+    // Number of signals received from the children.
+    std::atomic<unsigned> arrivals{0};
+    // Number of signals awaited so far. Only accessed by the owner thread.
+    unsigned awaited_arrivals = 0;
+    // Partial result of the subtree rooted at this node.
+    T value;
+  };  // struct Node
+
+  // Number of threads at the barrier.
+  const int num_threads_;
+
+  // Reduction operation.
+  Op op_;
+
+  // Nodes of each thread identity.
+  Node* nodes_;
+
+  // Padding to prevent false sharing.
+  char padding_[kCacheLineSize];
+
+  // Reduction of the last barrier synchronization.
+  T result_;
+
+  // Number of barrier synchronizations completed so far.
+  // The barrier is reusable since unsigned data type wraps around the overflow.
+  std::atomic<unsigned> step_{0};
+};  // class ReducingBarrier
+
+}  // namespace modcncy
+
+#endif  // MODCNCY_INCLUDE_MODCNCY_REDUCING_BARRIER_H_
@@ -0,0 +1,253 @@
+// Copyright 2022 The Modcncy Authors. All rights reserved.
+// Use of this source code is governed by the license found in the LICENSE file.
+// -----------------------------------------------------------------------------
+//
+// A task is a move-only callable returning nothing, stored inline in a buffer
+// of fixed capacity. It takes either no arguments, or the `WorkerContext` of
+// the thread running it.
+//
+// Unlike `std::function<void()>`, which allocates on the heap any callable not
+// fitting its small internal buffer, a task never allocates. A callable larger
+// than its capacity is rejected at compile-time:
+//
+//   modcncy::Task<> task = [begin, segment_size] { ... };
+//   ...
+//   if (task != nullptr) task();
+//
+// Tasks are the elements of the concurrent task queues, which thus store them
+// by value, without any per-task allocation.
+//
+// A worker context carries the index of the thread running tasks, and a scratch
+// buffer reused by all of them, so tasks needing temporary storage do not
+// allocate it on every run:
+//
+//   modcncy::WorkerContext context(thread_index);
+//   queue->Push([=](modcncy::WorkerContext& context) {
+//     int* buffer = context.Scratch<int>(2 * segment_size);
+//     ...
+//   });
+//   ...
+//   modcncy::Task<> task = queue->Pop();
+//   if (task != nullptr) task(context);
+//
+// -----------------------------------------------------------------------------
+
+#ifndef MODCNCY_INCLUDE_MODCNCY_TASK_H_
+#define MODCNCY_INCLUDE_MODCNCY_TASK_H_
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace modcncy {
+
+// Context of a thread running tasks.
+class WorkerContext {
+ public:
+  explicit WorkerContext(int thread_index = 0) : thread_index_(thread_index) {}
+
+  WorkerContext(const WorkerContext&) = delete;
+  WorkerContext& operator=(const WorkerContext&) = delete;
+
+  // Index of the thread running the tasks.
+  int thread_index() const { return thread_index_; }
+
+  // Returns a buffer of at least `size` objects of type `T`, shared by all
+  // tasks run with this context. It only grows, so its contents are
+  // unspecified, and only valid until the next call. Trivial objects share raw
+  // storage. Other objects are default-constructed in a buffer of their type,
+  // as it grows, and are destroyed with the context.
+  template <typename T>
+  T* Scratch(size_t size) {
+    return Scratch<T>(size, std::is_trivial<T>());
+  }
+
+ private:
+  // Buffer of objects of a type that is not trivial.
+  struct ObjectScratchBase {
+    virtual ~ObjectScratchBase() {}
+  };  // struct ObjectScratchBase
+
+  template <typename T>
+  struct ObjectScratch : ObjectScratchBase {
+    // Its address identifies the buffers of type `T`.
+    static char type_key;
+    std::vector<T> objects;
+  };  // struct ObjectScratch
+
+  template <typename T>
+  T* Scratch(size_t size, std::true_type /*is_trivial*/) {
+    const size_t num_blocks =
+        (size * sizeof(T) + sizeof(std::max_align_t) - 1) /
+        sizeof(std::max_align_t);
+    if (scratch_.size() < num_blocks) scratch_.resize(num_blocks);
+    return reinterpret_cast<T*>(scratch_.data());
+  }
+
+  template <typename T>
+  T* Scratch(size_t size, std::false_type /*is_trivial*/) {
+    // A context sees few types, so a linear search finds their buffers.
+    ObjectScratch<T>* scratch = nullptr;
+    for (const auto& object_scratch : object_scratches_) {
+      if (object_scratch.first == &ObjectScratch<T>::type_key) {
+        scratch = static_cast<ObjectScratch<T>*>(object_scratch.second.get());
+        break;
+      }
+    }
+    if (scratch == nullptr) {
+      scratch = new ObjectScratch<T>();
+      object_scratches_.emplace_back(
+          &ObjectScratch<T>::type_key,
+          std::unique_ptr<ObjectScratchBase>(scratch));
+    }
+    if (scratch->objects.size() < size) scratch->objects.resize(size);
+    return scratch->objects.data();
+  }
+
+  const int thread_index_;
+  std::vector<std::max_align_t> scratch_;
+  std::vector<std::pair<const char*, std::unique_ptr<ObjectScratchBase>>>
+      object_scratches_;
+};  // class WorkerContext
+
+template <typename T>
+char WorkerContext::ObjectScratch<T>::type_key;
+
+// Default capacity of a task, in Bytes. Fits eight pointers or integers.
+static constexpr size_t kDefaultTaskCapacity = 64;
+
+template <size_t kCapacity = kDefaultTaskCapacity>
+class Task {
+ public:
+  // Empty task.
+  Task() {}
+  Task(std::nullptr_t) {}  // NOLINT(runtime/explicit)
+
+  // Stores a copy of `callable`, or moves it if it is an rvalue. It may take a
+  // `WorkerContext&` as its only argument.
+  template <typename Callable,
+            typename = typename std::enable_if<
+                !std::is_same<typename std::decay<Callable>::type,
+                              Task>::value>::type>
+  Task(Callable&& callable)  // NOLINT(runtime/explicit)
+      : invoke_(&Invoke<typename std::decay<Callable>::type>),
+        relocate_(&Relocate<typename std::decay<Callable>::type>) {
+    typedef typename std::decay<Callable>::type Stored;
+    static_assert(sizeof(Stored) <= kCapacity,
+                  "The captures of the callable exceed the task capacity.");
+    static_assert(alignof(Stored) <= alignof(Storage),
+                  "The callable is over-aligned for a task.");
+    new (&storage_) Stored(std::forward<Callable>(callable));
+  }
+
+  Task(Task&& other) noexcept { MoveFrom(&other); }
+
+  Task& operator=(Task&& other) noexcept {
+    if (this != &other) {
+      Reset();
+      MoveFrom(&other);
+    }
+    return *this;
+  }
+
+  Task& operator=(std::nullptr_t) noexcept {
+    Reset();
+    return *this;
+  }
+
+  Task(const Task&) = delete;
+  Task& operator=(const Task&) = delete;
+
+  ~Task() { Reset(); }
+
+  // Runs the stored callable with `context`. The task must not be empty.
+  void operator()(WorkerContext& context) { invoke_(&storage_, &context); }
+
+  // Runs the stored callable with a context of its own. The task must not be
+  // empty.
+  void operator()() {
+    WorkerContext context;
+    invoke_(&storage_, &context);
+  }
+
+  // Returns whether the task holds a callable.
+  explicit operator bool() const noexcept { return invoke_ != nullptr; }
+
+  friend bool operator==(const Task& task, std::nullptr_t) noexcept {
+    return !task;
+  }
+  friend bool operator==(std::nullptr_t, const Task& task) noexcept {
+    return !task;
+  }
+  friend bool operator!=(const Task& task, std::nullptr_t) noexcept {
+    return static_cast<bool>(task);
+  }
+  friend bool operator!=(std::nullptr_t, const Task& task) noexcept {
+    return static_cast<bool>(task);
+  }
+
+ private:
+  typedef typename std::aligned_storage<kCapacity>::type Storage;
+
+  // Calls the `Callable` stored in `storage`, with `context` if it takes it.
+  template <typename Callable>
+  static void Invoke(void* storage, WorkerContext* context) {
+    Call(static_cast<Callable*>(storage), context, TakesContext());
+  }
+
+  // Tags of the overloads of `Call()`. The one taking `TakesContext` is the
+  // better match, chosen whenever it compiles.
+  struct TakesNoArguments {};
+  struct TakesContext : TakesNoArguments {};
+
+  template <typename Callable>
+  static auto Call(Callable* callable, WorkerContext* context, TakesContext)
+      -> decltype((*callable)(*context), void()) {
+    (*callable)(*context);
+  }
+
+  template <typename Callable>
+  static void Call(Callable* callable, WorkerContext* /*context*/,
+                   TakesNoArguments) {
+    (*callable)();
+  }
+
+  // Moves the `Callable` stored in `source` into `destination`, unless it is
+  // `nullptr`, and destroys it.
+  template <typename Callable>
+  static void Relocate(void* destination, void* source) {
+    Callable* callable = static_cast<Callable*>(source);
+    if (destination != nullptr)
+      new (destination) Callable(std::move(*callable));
+    callable->~Callable();
+  }
+
+  // Takes the callable of `other`, leaving it empty. This task must be empty.
+  void MoveFrom(Task* other) {
+    if (other->invoke_ == nullptr) return;
+    other->relocate_(&storage_, &other->storage_);
+    invoke_ = other->invoke_;
+    relocate_ = other->relocate_;
+    other->invoke_ = nullptr;
+    other->relocate_ = nullptr;
+  }
+
+  // Destroys the stored callable, if any.
+  void Reset() {
+    if (invoke_ == nullptr) return;
+    relocate_(nullptr, &storage_);
+    invoke_ = nullptr;
+    relocate_ = nullptr;
+  }
+
+  Storage storage_;
+  void (*invoke_)(void*, WorkerContext*) = nullptr;
+  void (*relocate_)(void*, void*) = nullptr;
+};  // class Task
+
+}  // namespace modcncy
+
+#endif  // MODCNCY_INCLUDE_MODCNCY_TASK_H_
@@ -0,0 +1,162 @@
+// Copyright 2022 The Modcncy Authors. All rights reserved.
+// Use of this source code is governed by the license found in the LICENSE file.
+// -----------------------------------------------------------------------------
+//
+// Header-only barriers specialized at compile-time.
+//
+// The runtime `Barrier` interface pays for a virtual call on every `Wait()` and
+// for a call through a `std::function` on every iteration of the spin-wait
+// loop. The barriers in this file take the wait policy as a type instead, so
+// the whole spin-wait loop can be inlined at the call site:
+//
+//   modcncy::CentralSenseCounterBarrierT<modcncy::PauseWaitPolicy> barrier;
+//   ...
+//   barrier.Wait(num_threads);  // From every thread.
+//
+// An optional completion function type runs, as in `Barrier::SetCompletion()`,
+// on the last arriving thread before all other threads are released. An
+// optional notification function type runs on the same thread right after the
+// release, for instance to notify an `EventCount` threads are parked on.
+//
+// The central barriers behind `Barrier::Create()` are thin wrappers of these,
+// instantiated with `std::function<void()>` as their wait policy.
+//
+// -----------------------------------------------------------------------------
+
+#ifndef MODCNCY_INCLUDE_MODCNCY_TEMPLATED_BARRIER_H_
+#define MODCNCY_INCLUDE_MODCNCY_TEMPLATED_BARRIER_H_
+
+#include <atomic>
+#include <utility>
+
+#include "modcncy/barrier.h"
+#include "modcncy/global_expressions.h"
+#include "modcncy/wait_policy.h"
+
+namespace modcncy {
+
+// Completion function that does nothing.
+struct NoCompletion {
+  void operator()() const {}
+};  // struct NoCompletion
+
+// Notification function that does nothing.
+struct NoNotification {
+  void operator()() const {}
+};  // struct NoNotification
+
+// =============================================================================
+// Central sense counter barrier. See `BarrierType::kCentralSenseCounterBarrier`.
+template <typename WaitPolicy, typename Completion = NoCompletion,
+          typename Notification = NoNotification>
+class CentralSenseCounterBarrierT {
+ public:
+  explicit CentralSenseCounterBarrierT(
+      Completion completion = Completion(),
+      Notification notification = Notification())
+      : completion_(std::move(completion)),
+        notification_(std::move(notification)) {}
+
+  // A thread must wait here until all threads reach this point.
+  void Wait(int num_threads, WaitPolicy policy = WaitPolicy()) {
+    Wait(Arrive(num_threads), std::move(policy));
+  }
+
+  // A thread signals its arrival without waiting for all other threads.
+  Barrier::Token Arrive(int num_threads) {
+    const unsigned my_sense = sense_.load(std::memory_order_relaxed);
+    if (spinning_threads_.fetch_add(1, std::memory_order_acq_rel) >=
+        num_threads - 1) {
+      // Last thread enters the barrier.
+      // Run the completion function, reset number of spinning threads, toggle
+      // the global sense and run the notification function.
+      completion_();
+      spinning_threads_.store(0, std::memory_order_relaxed);
+      sense_.store(~my_sense, std::memory_order_release);
+      notification_();
+    }
+    return Barrier::Token{my_sense, 0};
+  }
+
+  // A thread must wait here until all threads arrive at the `token` phase.
+  void Wait(Barrier::Token token, WaitPolicy policy = WaitPolicy()) {
+    // Wait until last thread arrives.
+    WatchAddress(&policy, &sense_);
+    while (sense_.load(std::memory_order_acquire) == token.phase) policy();
+  }
+
+ private:
+  // Number of threads spinning at the barrier.
+  std::atomic<int> spinning_threads_{0};
+
+  // Padding to prevent false sharing.
+  char padding_[kCacheLineSize - sizeof(std::atomic<int>)];
+
+  // Global sense flag.
+  // The barrier is reusable since it flips between states.
+  std::atomic<unsigned> sense_{0};
+
+  // Functions run by the last arriving thread.
+  Completion completion_;
+  Notification notification_;
+};  // class CentralSenseCounterBarrierT
+
+// =============================================================================
+// Central step counter barrier. See `BarrierType::kCentralStepCounterBarrier`.
+template <typename WaitPolicy, typename Completion = NoCompletion,
+          typename Notification = NoNotification>
+class CentralStepCounterBarrierT {
+ public:
+  explicit CentralStepCounterBarrierT(
+      Completion completion = Completion(),
+      Notification notification = Notification())
+      : completion_(std::move(completion)),
+        notification_(std::move(notification)) {}
+
+  // A thread must wait here until all threads reach this point.
+  void Wait(int num_threads, WaitPolicy policy = WaitPolicy()) {
+    Wait(Arrive(num_threads), std::move(policy));
+  }
+
+  // A thread signals its arrival without waiting for all other threads.
+  Barrier::Token Arrive(int num_threads) {
+    const unsigned current_step = step_.load(std::memory_order_relaxed);
+    if (spinning_threads_.fetch_add(1, std::memory_order_acq_rel) >=
+        num_threads - 1) {
+      // Last thread enters the barrier.
+      // Run the completion function, reset number of spinning threads,
+      // increase the step and run the notification function.
+      completion_();
+      spinning_threads_.store(0, std::memory_order_relaxed);
+      step_.fetch_add(1, std::memory_order_release);
+      notification_();
+    }
+    return Barrier::Token{current_step, 0};
+  }
+
+  // A thread must wait here until all threads arrive at the `token` phase.
+  void Wait(Barrier::Token token, WaitPolicy policy = WaitPolicy()) {
+    // Wait until last thread arrives.
+    WatchAddress(&policy, &step_);
+    while (step_.load(std::memory_order_acquire) == token.phase) policy();
+  }
+
+ private:
+  // Number of threads spinning at the barrier.
+  std::atomic<int> spinning_threads_{0};
+
+  // Padding to prevent false sharing.
+  char padding_[kCacheLineSize - sizeof(std::atomic<int>)];
+
+  // Number of barrier synchronizations completed so far.
+  // The barrier is reusable since unsigned data type wraps around the overflow.
+  std::atomic<unsigned> step_{0};
+
+  // Functions run by the last arriving thread.
+  Completion completion_;
+  Notification notification_;
+};  // class CentralStepCounterBarrierT
+
+}  // namespace modcncy
+
+#endif  // MODCNCY_INCLUDE_MODCNCY_TEMPLATED_BARRIER_H_
@@ -0,0 +1,37 @@
+// Copyright 2022 The Modcncy Authors. All rights reserved.
+// Use of this source code is governed by the license found in the LICENSE file.
+// -----------------------------------------------------------------------------
+//
+// Utilities to pin execution threads to the CPUs of the host, following its
+// NUMA layout as exposed by Linux under `/sys/devices/system/node`.
+//
+// -----------------------------------------------------------------------------
+
+#ifndef MODCNCY_INCLUDE_MODCNCY_THREAD_AFFINITY_H_
+#define MODCNCY_INCLUDE_MODCNCY_THREAD_AFFINITY_H_
+
+namespace modcncy {
+
+// Returns the number of NUMA nodes with CPUs in the host.
+int NumNumaNodes();
+
+// Pins the calling thread to a single CPU, among those it was allowed to run on
+// before it was first pinned, such as by `taskset` or a cpuset. Consecutive
+// values of `thread_index` are spread round-robin across the NUMA nodes, so
+// threads `0` and `1` land on different sockets whenever there is more than
+// one. Returns `false` if the thread could not be pinned.
+bool PinThreadAcrossNodes(int thread_index);
+
+// Returns the number of CPUs `PinThreadAcrossNodes()` pins the calling thread
+// to. Values of `thread_index` that far apart share a CPU, so fewer CPUs than
+// threads pin some threads together. Returns `0` if they cannot be read.
+int NumPinnableCpus();
+
+// Restores the CPUs the calling thread was allowed to run on before it was
+// first pinned. Returns `false` if the affinity of the thread could not be
+// restored.
+bool UnpinThread();
+
+}  // namespace modcncy
+
+#endif  // MODCNCY_INCLUDE_MODCNCY_THREAD_AFFINITY_H_
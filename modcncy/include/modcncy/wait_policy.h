@@ -18,6 +18,30 @@
 //   + Paused Waiting: The thread hints the processor to "pause" and it can help
 //     optimize CPU performance and power consumption.
 //
+//   + Calibrated Waiting: The thread pauses for a target duration rather than
+//     a fixed number of times. The latency of a pause varies by an order of
+//     magnitude across CPU generations, so it is measured once at runtime.
+//
+//   + Backoff Waiting: The thread pauses for longer and longer between two
+//     checks of the condition, so many waiting threads load the shared cache
+//     line less often. Unlike the others, this policy keeps state, so it is
+//     either copied for every wait or reset after every wait to start over.
+//
+//   + Parked Waiting: The thread pauses for a while, then yields for a while,
+//     and finally sleeps until the signaling thread notifies it. The signaling
+//     side must notify an `EventCount` after every change of the condition, or
+//     a parked thread would sleep forever.
+//
+//   + Adaptive Waiting: The thread spins while its wait is expected to be
+//     short, and parks as in "Parked Waiting" when it is expected to be long.
+//     The expectation is learned online from the recent waits at the same
+//     site, as adaptive mutexes do for locks.
+//
+//   + Monitored Waiting: The thread monitors the cache line it spins on, and
+//     the processor enters a light sleep state until that line is written or a
+//     short deadline expires. It needs the WAITPKG instructions, detected at
+//     runtime, and otherwise it pauses as in "Paused Waiting".
+//
 // Note:
 //
 //   For more information on the "Paused Waiting" technique, search for the
@@ -39,6 +63,9 @@
 
 #include <emmintrin.h>
 
+#include <atomic>
+#include <cstdint>
+#include <functional>
 #include <thread>  // NOLINT(build/c++11)
 
 namespace modcncy {
@@ -55,6 +82,389 @@ inline void cpu_yield() { std::this_thread::yield(); }
 // Support for paused waiting. Tries to optimize the spin-wait loop.
 inline void cpu_pause() { _mm_pause(); }
 
+// =============================================================================
+// Wait policies as types, to be inlined in templated spin-wait loops.
+struct NoOpWaitPolicy {
+  void operator()() const { cpu_no_op(); }
+};  // struct NoOpWaitPolicy
+
+struct YieldWaitPolicy {
+  void operator()() const { cpu_yield(); }
+};  // struct YieldWaitPolicy
+
+struct PauseWaitPolicy {
+  void operator()() const { cpu_pause(); }
+};  // struct PauseWaitPolicy
+
+// =============================================================================
+// Returns the latency of a pause, in nanoseconds. It is measured on the first
+// call, which takes well under a millisecond, so callers may call it at startup
+// to keep the measurement off their critical path.
+double cpu_pause_latency_ns();
+
+// =============================================================================
+// Support for calibrated waiting. Every iteration pauses for about `pause_ns`
+// nanoseconds, and at least once, whatever the latency of a pause.
+class CalibratedPauseWaitPolicy {
+ public:
+  // Default duration of an iteration, in nanoseconds.
+  static constexpr int kDefaultPauseNs = 50;
+
+  explicit CalibratedPauseWaitPolicy(int pause_ns = kDefaultPauseNs)
+      : num_pauses_(static_cast<int>(pause_ns / cpu_pause_latency_ns() + 0.5)) {
+    if (num_pauses_ < 1) num_pauses_ = 1;
+  }
+
+  void operator()() const {
+    for (int i = 0; i < num_pauses_; ++i) cpu_pause();
+  }
+
+  // Returns the number of pauses of every iteration.
+  int NumPauses() const { return num_pauses_; }
+
+ private:
+  // Number of pauses of every iteration.
+  int num_pauses_;
+};  // class CalibratedPauseWaitPolicy
+
+// =============================================================================
+// Support for backoff waiting. Every iteration pauses twice as many times as
+// the previous one, from `min_pauses` up to `max_pauses`. If `yield_threshold`
+// is positive, iterations past that threshold yield the CPU instead.
+class ExponentialBackoffWaitPolicy {
+ public:
+  // Default bounds of the number of pauses per iteration.
+  static constexpr int kDefaultMinPauses = 1;
+  static constexpr int kDefaultMaxPauses = 64;
+
+  explicit ExponentialBackoffWaitPolicy(int min_pauses = kDefaultMinPauses,
+                                        int max_pauses = kDefaultMaxPauses,
+                                        int yield_threshold = 0)
+      : min_pauses_(min_pauses),
+        max_pauses_(max_pauses),
+        yield_threshold_(yield_threshold),
+        num_pauses_(min_pauses) {}
+
+  void operator()() {
+    if (yield_threshold_ > 0 && num_iterations_ >= yield_threshold_) {
+      cpu_yield();
+      return;
+    }
+    ++num_iterations_;
+    for (int i = 0; i < num_pauses_; ++i) cpu_pause();
+    num_pauses_ = num_pauses_ < max_pauses_ / 2 ? 2 * num_pauses_ : max_pauses_;
+  }
+
+  // Returns the number of pauses of the next iteration. Zero if it yields.
+  int NumPauses() const {
+    if (yield_threshold_ > 0 && num_iterations_ >= yield_threshold_) return 0;
+    return num_pauses_;
+  }
+
+  // Starts over from `min_pauses`.
+  void Reset() {
+    num_pauses_ = min_pauses_;
+    num_iterations_ = 0;
+  }
+
+ private:
+  // Bounds of the number of pauses per iteration.
+  int min_pauses_;
+  int max_pauses_;
+
+  // Number of iterations before yielding, if positive.
+  int yield_threshold_;
+
+  // Number of pauses of the next iteration.
+  int num_pauses_;
+
+  // Number of iterations so far.
+  int num_iterations_ = 0;
+};  // class ExponentialBackoffWaitPolicy
+
+// =============================================================================
+// Notification counterpart of parked waiting. Threads park on it until another
+// thread notifies them, on top of a Linux futex:
+//
+//   1. A waiting thread reads the current epoch before checking its condition.
+//      If the condition does not hold, it parks until the epoch changes.
+//
+//   2. A signaling thread changes the condition and then increases the epoch.
+//      Only if some thread is parked, it wakes all of them up.
+//
+// A notification between the read of the epoch and the parking changes the
+// epoch, so the waiting thread does not park at all and no wake-up is lost.
+class EventCount {
+ public:
+  // Returns the current epoch.
+  unsigned Epoch() const {
+    return static_cast<unsigned>(epoch_.load(std::memory_order_acquire));
+  }
+
+  // Parks current thread until the epoch moves past `epoch`.
+  void Wait(unsigned epoch);
+
+  // Wakes up all parked threads. To be called after changing the condition
+  // they wait for.
+  void NotifyAll();
+
+ private:
+  // Number of notifications so far. Its address is the futex word parked
+  // threads sleep on.
+  std::atomic<int> epoch_{0};
+
+  // Number of threads parked (or about to park).
+  std::atomic<int> num_waiters_{0};
+};  // class EventCount
+
+// =============================================================================
+// Support for parked waiting. The first `num_spins` iterations pause, the next
+// `num_yields` iterations yield the CPU, and later iterations park on the
+// `event_count` until notified. Without an `event_count`, it keeps yielding.
+// It keeps state, so it is meant to be copied or reset for every wait.
+class SpinYieldParkWaitPolicy {
+ public:
+  // Default number of iterations of each stage.
+  static constexpr int kDefaultNumSpins = 128;
+  static constexpr int kDefaultNumYields = 16;
+
+  explicit SpinYieldParkWaitPolicy(EventCount* event_count,
+                                   int num_spins = kDefaultNumSpins,
+                                   int num_yields = kDefaultNumYields)
+      : event_count_(event_count),
+        num_spins_(num_spins),
+        num_yields_(num_yields) {}
+
+  void operator()() {
+    // Parking needs the epoch read before the caller last checked the
+    // condition, which only a previous iteration could have read.
+    const bool can_park = event_count_ != nullptr && num_iterations_ > 0;
+    if (num_iterations_ < num_spins_)
+      cpu_pause();
+    else if (num_iterations_ < num_spins_ + num_yields_ || !can_park)
+      cpu_yield();
+    else
+      event_count_->Wait(epoch_);
+    if (num_iterations_ <= num_spins_ + num_yields_) ++num_iterations_;
+    if (event_count_ != nullptr) epoch_ = event_count_->Epoch();
+  }
+
+  // Starts over from pausing.
+  void Reset() {
+    num_iterations_ = 0;
+    epoch_ = 0;
+  }
+
+ private:
+  // Event count to park on, if any.
+  EventCount* event_count_;
+
+  // Number of iterations pausing and yielding before parking.
+  int num_spins_;
+  int num_yields_;
+
+  // Number of iterations so far, up to the first parking one.
+  int num_iterations_ = 0;
+
+  // Epoch read at the end of the previous iteration.
+  unsigned epoch_ = 0;
+};  // class SpinYieldParkWaitPolicy
+
+// =============================================================================
+// Online estimate of how long the waits at a spin site last, such as a barrier
+// instance or a thread of a lock-free algorithm. Every wait folds its duration
+// into an exponentially weighted moving average, so the estimate follows the
+// recent waits. Concurrent updates may overwrite each other, which only drops
+// some samples.
+class WaitEstimate {
+ public:
+  // Inverse of the weight of a new sample, as in glibc adaptive mutexes.
+  static constexpr int64_t kSampleWeight = 8;
+
+  // Returns the expected duration of the next wait, in nanoseconds.
+  int64_t ExpectedNs() const {
+    return expected_ns_.load(std::memory_order_relaxed);
+  }
+
+  // Folds the duration of a finished wait, in nanoseconds, into the estimate.
+  void Record(int64_t wait_ns) {
+    const int64_t expected_ns = ExpectedNs();
+    expected_ns_.store(expected_ns + (wait_ns - expected_ns) / kSampleWeight,
+                       std::memory_order_relaxed);
+  }
+
+  // Discards the recent waits.
+  void Reset() { expected_ns_.store(0, std::memory_order_relaxed); }
+
+ private:
+  // Expected duration of the next wait, in nanoseconds.
+  std::atomic<int64_t> expected_ns_{0};
+};  // class WaitEstimate
+
+// =============================================================================
+// Support for adaptive waiting. Every wait reads the `estimate` of its spin
+// site once, and sets how long it spins before parking from it:
+//
+//   + A wait expected to last up to `max_spin_ns` spins for twice as long as
+//     expected, plus `kMinSpinNs`, so it most likely ends while spinning.
+//
+//   + A wait expected to last longer only spins for `kMinSpinNs`, since
+//     spinning for most of it would burn CPU time for nothing.
+//
+// Past that, it parks on the `event_count` until notified, or yields the CPU
+// without one. The duration of a wait is folded into the `estimate` when the
+// policy is destroyed or reset, if it iterated at all. So it is meant to be
+// copied for every wait, as copies start over, or reset right after every wait.
+class AdaptiveWaitPolicy {
+ public:
+  // Time every wait spins at least, in nanoseconds.
+  static constexpr int64_t kMinSpinNs = 1000;
+  // Default longest expected wait worth spinning for, in nanoseconds.
+  static constexpr int64_t kDefaultMaxSpinNs = 50000;
+
+  explicit AdaptiveWaitPolicy(WaitEstimate* estimate,
+                              EventCount* event_count = nullptr,
+                              int64_t max_spin_ns = kDefaultMaxSpinNs)
+      : estimate_(estimate),
+        event_count_(event_count),
+        max_spin_ns_(max_spin_ns) {}
+
+  AdaptiveWaitPolicy(const AdaptiveWaitPolicy& other)
+      : AdaptiveWaitPolicy(other.estimate_, other.event_count_,
+                           other.max_spin_ns_) {}
+  AdaptiveWaitPolicy& operator=(const AdaptiveWaitPolicy&) = delete;
+
+  ~AdaptiveWaitPolicy();
+
+  void operator()();
+
+  // Ends the current wait, if any, so the next iteration starts a new one.
+  void Reset();
+
+  // Returns how long a wait starting now spins before parking, in nanoseconds.
+  int64_t SpinNs() const;
+
+ private:
+  // Estimate of the spin site.
+  WaitEstimate* estimate_;
+
+  // Event count to park on, if any.
+  EventCount* event_count_;
+
+  // Longest expected wait worth spinning for, in nanoseconds.
+  int64_t max_spin_ns_;
+
+  // Whether the current wait iterated at least once.
+  bool is_waiting_ = false;
+
+  // Start of the current wait, and how long it spins, in nanoseconds.
+  int64_t start_ns_ = 0;
+  int64_t spin_ns_ = 0;
+
+  // Epoch read at the end of the previous iteration.
+  unsigned epoch_ = 0;
+};  // class AdaptiveWaitPolicy
+
+// =============================================================================
+// Returns whether the CPU supports the WAITPKG instructions (`UMONITOR`,
+// `UMWAIT` and `TPAUSE`). Detected once with `CPUID`.
+bool cpu_has_waitpkg();
+
+// =============================================================================
+// Support for monitored waiting. Every iteration arms a monitor on the watched
+// address, and then sleeps in the C0.1 state until the monitored cache line is
+// written or `max_cycles` timestamp counter cycles elapse. Without an address,
+// it only sleeps for `max_cycles`. Without WAITPKG support, it pauses instead.
+//
+// The policy reads the watched word at the end of every iteration, before the
+// caller checks its condition again, and only sleeps while that word is still
+// unchanged once the monitor is armed. So a write between the check and the
+// arming of the monitor is not missed. It keeps state, so it is meant to be
+// copied or reset for every wait.
+class MonitorWaitPolicy {
+ public:
+  // Default deadline of a sleep, in timestamp counter cycles.
+  static constexpr uint32_t kDefaultMaxCycles = 10000;
+
+  explicit MonitorWaitPolicy(const void* address = nullptr,
+                             uint32_t max_cycles = kDefaultMaxCycles)
+      : address_(address), max_cycles_(max_cycles) {}
+
+  void operator()();
+
+  // Watches `address`, the word the caller spins on from now on.
+  void Watch(const void* address) {
+    address_ = address;
+    has_value_ = false;
+  }
+
+  // Forgets the watched word, but keeps watching the same address.
+  void Reset() { has_value_ = false; }
+
+  // Returns the watched address.
+  const void* Address() const { return address_; }
+
+ private:
+  // Watched address, if any.
+  const void* address_;
+
+  // Deadline of a sleep, in timestamp counter cycles.
+  uint32_t max_cycles_;
+
+  // Watched word, read at the end of the previous iteration.
+  unsigned value_ = 0;
+  bool has_value_ = false;
+};  // class MonitorWaitPolicy
+
+// =============================================================================
+// Makes an address-aware `policy` watch the `address` that is spun on next.
+// Other policies ignore it.
+template <typename WaitPolicy>
+inline void WatchAddress(WaitPolicy* /*policy*/, const void* /*address*/) {}
+
+inline void WatchAddress(MonitorWaitPolicy* policy, const void* address) {
+  policy->Watch(address);
+}
+
+inline void WatchAddress(std::function<void()>* policy, const void* address) {
+  MonitorWaitPolicy* monitor_policy = policy->target<MonitorWaitPolicy>();
+  if (monitor_policy != nullptr) monitor_policy->Watch(address);
+}
+
+// =============================================================================
+// Makes a stateful `policy` start over, as a fresh copy of it would, without
+// the cost of copying it. To be called right after a wait ends, so an adaptive
+// policy records how long it lasted. Stateless policies ignore it.
+template <typename WaitPolicy>
+inline void ResetWaitPolicy(WaitPolicy* /*policy*/) {}
+
+inline void ResetWaitPolicy(ExponentialBackoffWaitPolicy* policy) {
+  policy->Reset();
+}
+
+inline void ResetWaitPolicy(SpinYieldParkWaitPolicy* policy) {
+  policy->Reset();
+}
+
+inline void ResetWaitPolicy(AdaptiveWaitPolicy* policy) { policy->Reset(); }
+
+inline void ResetWaitPolicy(MonitorWaitPolicy* policy) { policy->Reset(); }
+
+inline void ResetWaitPolicy(std::function<void()>* policy) {
+  if (ExponentialBackoffWaitPolicy* backoff_policy =
+          policy->target<ExponentialBackoffWaitPolicy>())
+    backoff_policy->Reset();
+  else if (SpinYieldParkWaitPolicy* park_policy =
+               policy->target<SpinYieldParkWaitPolicy>())
+    park_policy->Reset();
+  else if (AdaptiveWaitPolicy* adaptive_policy =
+               policy->target<AdaptiveWaitPolicy>())
+    adaptive_policy->Reset();
+  else if (MonitorWaitPolicy* monitor_policy =
+               policy->target<MonitorWaitPolicy>())
+    monitor_policy->Reset();
+}
+
 }  // namespace modcncy
 
 #endif  // MODCNCY_INCLUDE_MODCNCY_WAIT_POLICY_H_
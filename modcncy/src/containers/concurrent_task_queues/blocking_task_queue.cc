@@ -4,27 +4,57 @@
 
 #include "modcncy/src/containers/concurrent_task_queues/blocking_task_queue.h"
 
+#include <algorithm>
 #include <utility>
 
 namespace modcncy {
 namespace containers {
 
 // =============================================================================
-void BlockingTaskQueue::Push(std::function<void()> task) {
+void BlockingTaskQueue::Push(Task<> task) {
   std::lock_guard<std::mutex> lock(mutex_);
-  queue_.push_back(task);
+  queue_.push_back(std::move(task));
 }
 
 // =============================================================================
-std::function<void()> BlockingTaskQueue::Pop() {
+Task<> BlockingTaskQueue::Pop() {
   std::lock_guard<std::mutex> lock(mutex_);
   if (!queue_.empty()) {
-    std::function<void()> task = std::move(queue_.front());
+    Task<> task = std::move(queue_.front());
     queue_.pop_front();
     return task;
   }
   return nullptr;
 }
 
+// =============================================================================
+void BlockingTaskQueue::PushBulk(Task<>* first, Task<>* last) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (Task<>* task = first; task != last; ++task)
+    queue_.push_back(std::move(*task));
+}
+
+// =============================================================================
+size_t BlockingTaskQueue::PopBatch(Task<>* tasks, size_t max_tasks) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const size_t num_tasks = std::min(max_tasks, queue_.size());
+  for (size_t i = 0; i < num_tasks; ++i) {
+    tasks[i] = std::move(queue_.front());
+    queue_.pop_front();
+  }
+  return num_tasks;
+}
+
+// =============================================================================
+size_t BlockingTaskQueue::StealBatch(Task<>* tasks, size_t max_tasks) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const size_t num_tasks = std::min(max_tasks, (queue_.size() + 1) / 2);
+  for (size_t i = 0; i < num_tasks; ++i) {
+    tasks[i] = std::move(queue_.front());
+    queue_.pop_front();
+  }
+  return num_tasks;
+}
+
 }  // namespace containers
 }  // namespace modcncy
@@ -10,6 +10,7 @@
 #ifndef MODCNCY_SRC_CONTAINERS_CONCURRENT_TASK_QUEUES_BLOCKING_TASK_QUEUE_H_
 #define MODCNCY_SRC_CONTAINERS_CONCURRENT_TASK_QUEUES_BLOCKING_TASK_QUEUE_H_
 
+#include <cstddef>
 #include <deque>
 #include <mutex>  // NOLINT(build/c++11)
 
@@ -21,17 +22,26 @@ namespace containers {
 class BlockingTaskQueue : public ConcurrentTaskQueue {
  public:
   // Inserts a task into the queue.
-  void Push(std::function<void()> task) override;
+  void Push(Task<> task) override;
 
   // Removes a task from the queue.
-  std::function<void()> Pop() override;
+  Task<> Pop() override;
+
+  // Inserts many tasks into the queue, under a single lock.
+  void PushBulk(Task<>* first, Task<>* last) override;
+
+  // Removes many tasks from the queue, under a single lock.
+  size_t PopBatch(Task<>* tasks, size_t max_tasks) override;
+
+  // Removes up to half the tasks of the queue, under a single lock.
+  size_t StealBatch(Task<>* tasks, size_t max_tasks) override;
 
  private:
   // Protects the concurrent reads/writes from/to the queue.
   std::mutex mutex_;
 
   // Using `std::deque` for pointer consistency and FIFO order.
-  std::deque<std::function<void()>> queue_;
+  std::deque<Task<>> queue_;
 };  // class BlockingTaskQueue
 
 }  // namespace containers
@@ -0,0 +1,173 @@
+// Copyright 2022 The Modcncy Authors. All rights reserved.
+// Use of this source code is governed by the license found in the LICENSE file.
+// -----------------------------------------------------------------------------
+
+#include "modcncy/src/containers/concurrent_task_queues/bounded_lock_free_task_queue.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "modcncy/include/modcncy/wait_policy.h"
+
+namespace modcncy {
+namespace containers {
+namespace {
+
+// =============================================================================
+// Returns the smallest power of two not below `capacity`, and at least 2.
+size_t RoundUpCapacity(size_t capacity) {
+  size_t rounded = 2;
+  while (rounded < capacity) rounded <<= 1;
+  return rounded;
+}
+
+}  // namespace
+
+// =============================================================================
+BoundedLockFreeTaskQueue::BoundedLockFreeTaskQueue(size_t capacity)
+    : cells_(new Cell[RoundUpCapacity(capacity)]),
+      mask_(RoundUpCapacity(capacity) - 1) {
+  for (size_t i = 0; i <= mask_; ++i)
+    cells_[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+// =============================================================================
+BoundedLockFreeTaskQueue::~BoundedLockFreeTaskQueue() { delete[] cells_; }
+
+// =============================================================================
+void BoundedLockFreeTaskQueue::Push(Task<> task) {
+  Cell* cell;
+  size_t position = push_position_.load(std::memory_order_relaxed);
+  for (;;) {
+    cell = &cells_[position & mask_];
+    const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+    const ptrdiff_t difference = static_cast<ptrdiff_t>(sequence - position);
+    if (difference == 0) {
+      // The cell is free for this position. Claim it.
+      if (push_position_.compare_exchange_weak(position, position + 1,
+                                               std::memory_order_relaxed))
+        break;
+    } else if (difference < 0) {
+      // The cell still holds the task of the previous lap. Queue is full.
+      cpu_yield();
+      position = push_position_.load(std::memory_order_relaxed);
+    } else {
+      // Another producer claimed this position.
+      position = push_position_.load(std::memory_order_relaxed);
+    }
+  }
+  cell->task = std::move(task);
+  cell->sequence.store(position + 1, std::memory_order_release);
+}
+
+// =============================================================================
+Task<> BoundedLockFreeTaskQueue::Pop() {
+  Cell* cell;
+  size_t position = pop_position_.load(std::memory_order_relaxed);
+  for (;;) {
+    cell = &cells_[position & mask_];
+    const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+    const ptrdiff_t difference =
+        static_cast<ptrdiff_t>(sequence - (position + 1));
+    if (difference == 0) {
+      // The cell holds the task of this position. Claim it.
+      if (pop_position_.compare_exchange_weak(position, position + 1,
+                                              std::memory_order_relaxed))
+        break;
+    } else if (difference < 0) {
+      // No task has been published at this position yet. Queue is empty.
+      return nullptr;
+    } else {
+      // Another consumer claimed this position.
+      position = pop_position_.load(std::memory_order_relaxed);
+    }
+  }
+  Task<> task = std::move(cell->task);
+  // Release the captures of the task now, not when the cell is reused.
+  cell->task = nullptr;
+  cell->sequence.store(position + mask_ + 1, std::memory_order_release);
+  return task;
+}
+
+// =============================================================================
+void BoundedLockFreeTaskQueue::PushBulk(Task<>* first, Task<>* last) {
+  while (first != last) {
+    const size_t max_tasks = last - first;
+    size_t num_tasks;
+    size_t position = push_position_.load(std::memory_order_relaxed);
+    for (;;) {
+      // Count the consecutive cells free for their positions.
+      num_tasks = 0;
+      while (num_tasks < max_tasks &&
+             cells_[(position + num_tasks) & mask_].sequence.load(
+                 std::memory_order_acquire) == position + num_tasks)
+        ++num_tasks;
+      if (num_tasks > 0) {
+        // Claim them all.
+        if (push_position_.compare_exchange_weak(
+                position, position + num_tasks, std::memory_order_relaxed))
+          break;
+        continue;
+      }
+      const size_t sequence =
+          cells_[position & mask_].sequence.load(std::memory_order_acquire);
+      // The cell still holds the task of the previous lap. Queue is full.
+      if (static_cast<ptrdiff_t>(sequence - position) < 0) cpu_yield();
+      position = push_position_.load(std::memory_order_relaxed);
+    }
+    for (size_t i = 0; i < num_tasks; ++i) {
+      Cell* cell = &cells_[(position + i) & mask_];
+      cell->task = std::move(first[i]);
+      cell->sequence.store(position + i + 1, std::memory_order_release);
+    }
+    first += num_tasks;
+  }
+}
+
+// =============================================================================
+size_t BoundedLockFreeTaskQueue::PopBatch(Task<>* tasks, size_t max_tasks) {
+  if (max_tasks == 0) return 0;
+  size_t num_tasks;
+  size_t position = pop_position_.load(std::memory_order_relaxed);
+  for (;;) {
+    // Count the consecutive cells holding the tasks of their positions.
+    num_tasks = 0;
+    while (num_tasks < max_tasks &&
+           cells_[(position + num_tasks) & mask_].sequence.load(
+               std::memory_order_acquire) == position + num_tasks + 1)
+      ++num_tasks;
+    if (num_tasks > 0) {
+      // Claim them all.
+      if (pop_position_.compare_exchange_weak(position, position + num_tasks,
+                                              std::memory_order_relaxed))
+        break;
+      continue;
+    }
+    const size_t sequence =
+        cells_[position & mask_].sequence.load(std::memory_order_acquire);
+    // No task has been published at this position yet. Queue is empty.
+    if (static_cast<ptrdiff_t>(sequence - (position + 1)) < 0) return 0;
+    position = pop_position_.load(std::memory_order_relaxed);
+  }
+  for (size_t i = 0; i < num_tasks; ++i) {
+    Cell* cell = &cells_[(position + i) & mask_];
+    tasks[i] = std::move(cell->task);
+    cell->task = nullptr;
+    cell->sequence.store(position + i + mask_ + 1, std::memory_order_release);
+  }
+  return num_tasks;
+}
+
+// =============================================================================
+size_t BoundedLockFreeTaskQueue::StealBatch(Task<>* tasks, size_t max_tasks) {
+  // Read the pop position first, so it is not ahead of the push position.
+  const size_t pop_position = pop_position_.load(std::memory_order_relaxed);
+  const size_t push_position = push_position_.load(std::memory_order_relaxed);
+  // Try at least once, as the count may be stale.
+  const size_t num_tasks =
+      std::max<size_t>((push_position - pop_position + 1) / 2, 1);
+  return PopBatch(tasks, std::min(max_tasks, num_tasks));
+}
+
+}  // namespace containers
+}  // namespace modcncy
@@ -0,0 +1,94 @@
+// Copyright 2022 The Modcncy Authors. All rights reserved.
+// Use of this source code is governed by the license found in the LICENSE file.
+// -----------------------------------------------------------------------------
+//
+// The `BoundedLockFreeTaskQueue` is a bounded multi-producer multi-consumer
+// FIFO queue of tasks, on top of a ring buffer of cells, as proposed by Dmitry
+// Vyukov. Its behavior is summarized as follows:
+//
+//   1. Every cell holds a task and a sequence number. A cell at position `p` of
+//      the ring is free for the push at position `p` when its sequence is `p`,
+//      and holds the task for the pop at position `p` when it is `p + 1`.
+//
+//   2. Producers and consumers claim positions with a CAS on their own counter,
+//      after checking the sequence of the cell at that position, so they never
+//      take a lock and only contend with their own kind.
+//
+//   3. After moving the task in or out of the cell, a thread publishes it by
+//      advancing the sequence of the cell, to `p + 1` after a push and to
+//      `p + capacity` after a pop, that is, the next push at that cell.
+//
+// A pop finding the cell of its position not yet published sees an empty queue,
+// and a push finding it not yet popped sees a full queue and yields the CPU
+// until a consumer frees it.
+//
+// Batches claim as many consecutive positions as have their cells ready, with a
+// single CAS.
+//
+// -----------------------------------------------------------------------------
+
+#ifndef MODCNCY_SRC_CONTAINERS_CONCURRENT_TASK_QUEUES_BOUNDED_LOCK_FREE_TASK_QUEUE_H_  // NOLINT
+#define MODCNCY_SRC_CONTAINERS_CONCURRENT_TASK_QUEUES_BOUNDED_LOCK_FREE_TASK_QUEUE_H_  // NOLINT
+
+#include <atomic>
+#include <cstddef>
+
+#include "modcncy/include/modcncy/concurrent_task_queue.h"
+#include "modcncy/include/modcncy/global_expressions.h"
+
+namespace modcncy {
+namespace containers {
+
+class BoundedLockFreeTaskQueue : public ConcurrentTaskQueue {
+ public:
+  // Holds up to `capacity` tasks, rounded up to a power of two.
+  explicit BoundedLockFreeTaskQueue(size_t capacity);
+
+  BoundedLockFreeTaskQueue(const BoundedLockFreeTaskQueue&) = delete;
+  BoundedLockFreeTaskQueue& operator=(const BoundedLockFreeTaskQueue&) = delete;
+
+  ~BoundedLockFreeTaskQueue() override;
+
+  // Inserts a task into the queue. Waits while the queue is full.
+  void Push(Task<> task) override;
+
+  // Removes a task from the queue. Returns `nullptr` if it is empty.
+  Task<> Pop() override;
+
+  // Inserts many tasks into the queue. Waits while the queue is full.
+  void PushBulk(Task<>* first, Task<>* last) override;
+
+  // Removes many tasks from the queue.
+  size_t PopBatch(Task<>* tasks, size_t max_tasks) override;
+
+  // Removes up to half the tasks of the queue.
+  size_t StealBatch(Task<>* tasks, size_t max_tasks) override;
+
+ private:
+  // A slot of the ring buffer.
+  struct Cell {
+    std::atomic<size_t> sequence;
+    Task<> task;
+  };  // struct Cell
+
+  // Ring buffer of cells, and its capacity minus one.
+  Cell* const cells_;
+  const size_t mask_;
+
+  // Padding to prevent false sharing.
+  char padding_[kCacheLineSize];
+
+  // Position of the next push.
+  std::atomic<size_t> push_position_{0};
+
+  // Padding to prevent false sharing.
+  char padding2_[kCacheLineSize - sizeof(std::atomic<size_t>)];
+
+  // Position of the next pop.
+  std::atomic<size_t> pop_position_{0};
+};  // class BoundedLockFreeTaskQueue
+
+}  // namespace containers
+}  // namespace modcncy
+
+#endif  // MODCNCY_SRC_CONTAINERS_CONCURRENT_TASK_QUEUES_BOUNDED_LOCK_FREE_TASK_QUEUE_H_  // NOLINT
@@ -4,18 +4,65 @@
 
 #include "modcncy/include/modcncy/concurrent_task_queue.h"
 
+#include <utility>
+
 #include "modcncy/src/containers/concurrent_task_queues/blocking_task_queue.h"
+#include "modcncy/src/containers/concurrent_task_queues/bounded_lock_free_task_queue.h"
+#include "modcncy/src/containers/concurrent_task_queues/unbounded_lock_free_task_queue.h"
+#include "modcncy/src/containers/concurrent_task_queues/work_stealing_task_deque.h"
 
 namespace modcncy {
 
+// Constants odr-used by callers need a definition before C++17.
+constexpr size_t ConcurrentTaskQueue::kDefaultCapacity;
+constexpr size_t ConcurrentTaskQueue::kMaxStealBatch;
+
 // =============================================================================
 // Factory method. Creates a new `ConcurrentTaskQueue` object based on its type.
-ConcurrentTaskQueue* ConcurrentTaskQueue::Create(ConcurrentTaskQueueType type) {
+ConcurrentTaskQueue* ConcurrentTaskQueue::Create(ConcurrentTaskQueueType type,
+                                                 size_t capacity) {
   switch (type) {
     case ConcurrentTaskQueueType::kBlockingTaskQueue:
       return new containers::BlockingTaskQueue();
+    case ConcurrentTaskQueueType::kBoundedLockFreeTaskQueue:
+      return new containers::BoundedLockFreeTaskQueue(capacity);
+    case ConcurrentTaskQueueType::kWorkStealingTaskDeque:
+      return new containers::WorkStealingTaskDeque(capacity);
+    case ConcurrentTaskQueueType::kUnboundedLockFreeTaskQueue:
+      return new containers::UnboundedLockFreeTaskQueue();
   }
   return nullptr;
 }
 
+// =============================================================================
+void ConcurrentTaskQueue::PushBulk(Task<>* first, Task<>* last) {
+  for (Task<>* task = first; task != last; ++task) Push(std::move(*task));
+}
+
+// =============================================================================
+size_t ConcurrentTaskQueue::PopBatch(Task<>* tasks, size_t max_tasks) {
+  size_t num_tasks = 0;
+  while (num_tasks < max_tasks) {
+    Task<> task = Pop();
+    if (task == nullptr) break;
+    tasks[num_tasks++] = std::move(task);
+  }
+  return num_tasks;
+}
+
+// =============================================================================
+size_t ConcurrentTaskQueue::StealBatch(Task<>* tasks, size_t max_tasks) {
+  if (max_tasks == 0) return 0;
+  tasks[0] = Steal();
+  return tasks[0] != nullptr ? 1 : 0;
+}
+
+// =============================================================================
+size_t ConcurrentTaskQueue::StealHalf(ConcurrentTaskQueue* victim) {
+  Task<> tasks[kMaxStealBatch];
+  const size_t num_tasks = victim->StealBatch(tasks, kMaxStealBatch);
+  PushBulk(tasks, tasks + num_tasks);
+  return num_tasks;
+}
+
 }  // namespace modcncy
@@ -0,0 +1,361 @@
+// Copyright 2022 The Modcncy Authors. All rights reserved.
+// Use of this source code is governed by the license found in the LICENSE file.
+// -----------------------------------------------------------------------------
+
+#include "modcncy/src/containers/concurrent_task_queues/unbounded_lock_free_task_queue.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace modcncy {
+namespace containers {
+
+struct TaskQueueNode {
+  // Next node of the queue.
+  std::atomic<TaskQueueNode*> next{nullptr};
+
+  // Task held by the node, empty once it is the dummy node.
+  Task<> task;
+
+  // Next node of a free list, or of a list of retired nodes. Unlike `next`, it
+  // is never read by other threads while the node is in use.
+  TaskQueueNode* link = nullptr;
+};  // struct TaskQueueNode
+
+namespace {
+
+// Number of nodes a thread may need to protect at once.
+constexpr int kHazardsPerThread = 2;
+
+// Minimum number of retired nodes for a thread to look for reusable ones.
+constexpr size_t kMinScanThreshold = 64;
+
+// Maximum number of reusable nodes a thread keeps for itself.
+constexpr size_t kMaxFreeNodes = 256;
+
+// Hazard pointers owned by a thread.
+struct HazardRecord {
+  HazardRecord() {
+    for (auto& hazard : hazards)
+      hazard.store(nullptr, std::memory_order_relaxed);
+  }
+
+  // Nodes protected by the thread.
+  std::atomic<TaskQueueNode*> hazards[kHazardsPerThread];
+
+  // Whether a thread owns the record.
+  std::atomic<bool> in_use{true};
+
+  // Next record. Records are never removed.
+  HazardRecord* next = nullptr;
+};  // struct HazardRecord
+
+// =============================================================================
+// Inserts the list of nodes from `first` to `last` into `list`.
+void PushNodes(std::atomic<TaskQueueNode*>* list, TaskQueueNode* first,
+               TaskQueueNode* last) {
+  TaskQueueNode* head = list->load(std::memory_order_relaxed);
+  do {
+    last->link = head;
+  } while (!list->compare_exchange_weak(head, first, std::memory_order_release,
+                                        std::memory_order_relaxed));
+}
+
+// =============================================================================
+// Frees every node of the list starting at `node`.
+void DeleteNodes(TaskQueueNode* node) {
+  while (node != nullptr) {
+    TaskQueueNode* link = node->link;
+    delete node;
+    node = link;
+  }
+}
+
+// State shared by every thread.
+struct SharedState {
+  ~SharedState() {
+    DeleteNodes(free_nodes.load(std::memory_order_relaxed));
+    DeleteNodes(retired_nodes.load(std::memory_order_relaxed));
+    HazardRecord* record = records.load(std::memory_order_relaxed);
+    while (record != nullptr) {
+      HazardRecord* next = record->next;
+      delete record;
+      record = next;
+    }
+  }
+
+  // Hazard records of every thread, current or past.
+  std::atomic<HazardRecord*> records{nullptr};
+  std::atomic<size_t> num_records{0};
+
+  // Pool of reusable nodes handed over by threads.
+  std::atomic<TaskQueueNode*> free_nodes{nullptr};
+
+  // Retired nodes left behind by exited threads.
+  std::atomic<TaskQueueNode*> retired_nodes{nullptr};
+};  // struct SharedState
+
+// =============================================================================
+SharedState& GetSharedState() {
+  static SharedState shared_state;
+  return shared_state;
+}
+
+// Hazard pointers, retired nodes and free nodes of the calling thread.
+class ThreadContext {
+ public:
+  ThreadContext() : shared_(GetSharedState()), record_(AcquireRecord()) {}
+
+  ThreadContext(const ThreadContext&) = delete;
+  ThreadContext& operator=(const ThreadContext&) = delete;
+
+  // Hands over everything the thread holds, as it is exiting.
+  ~ThreadContext() {
+    ClearHazards();
+    Scan();
+    if (!retired_.empty()) {
+      for (size_t i = 1; i < retired_.size(); ++i)
+        retired_[i - 1]->link = retired_[i];
+      PushNodes(&shared_.retired_nodes, retired_.front(), retired_.back());
+    }
+    HandOverFreeNodes(/*num_kept_nodes=*/0);
+    record_->in_use.store(false, std::memory_order_release);
+  }
+
+  // Publishes that the thread is about to read `node`. Callers must then check
+  // that `node` is still reachable before reading it.
+  void Protect(int index, TaskQueueNode* node) {
+    record_->hazards[index].store(node, std::memory_order_seq_cst);
+  }
+
+  // Publishes that the thread is not reading any node.
+  void ClearHazards() {
+    for (auto& hazard : record_->hazards)
+      hazard.store(nullptr, std::memory_order_release);
+  }
+
+  // Returns a node with no next node and no task.
+  TaskQueueNode* AllocateNode() {
+    if (free_nodes_ == nullptr) TakeFreeNodes();
+    if (free_nodes_ == nullptr) return new TaskQueueNode();
+    TaskQueueNode* node = free_nodes_;
+    free_nodes_ = node->link;
+    --num_free_nodes_;
+    node->next.store(nullptr, std::memory_order_relaxed);
+    return node;
+  }
+
+  // Reuses `node`, no longer reachable, once no thread is reading it.
+  void Retire(TaskQueueNode* node) {
+    retired_.push_back(node);
+    const size_t threshold = std::max(
+        kMinScanThreshold,
+        2 * kHazardsPerThread *
+            shared_.num_records.load(std::memory_order_relaxed));
+    if (retired_.size() >= threshold) Scan();
+  }
+
+ private:
+  // Returns a hazard record no other thread owns.
+  HazardRecord* AcquireRecord() {
+    HazardRecord* head = shared_.records.load(std::memory_order_acquire);
+    for (HazardRecord* record = head; record != nullptr;
+         record = record->next) {
+      bool in_use = false;
+      if (!record->in_use.load(std::memory_order_relaxed) &&
+          record->in_use.compare_exchange_strong(in_use, true,
+                                                 std::memory_order_acquire))
+        return record;
+    }
+    HazardRecord* record = new HazardRecord();
+    shared_.num_records.fetch_add(1, std::memory_order_relaxed);
+    do {
+      record->next = head;
+    } while (!shared_.records.compare_exchange_weak(
+        head, record, std::memory_order_release, std::memory_order_acquire));
+    return record;
+  }
+
+  // Moves the retired nodes no thread is reading to the free list.
+  void Scan() {
+    // Adopt the retired nodes left behind by exited threads.
+    TaskQueueNode* node =
+        shared_.retired_nodes.exchange(nullptr, std::memory_order_acquire);
+    while (node != nullptr) {
+      retired_.push_back(node);
+      node = node->link;
+    }
+    // Read the hazards after the retired nodes were made unreachable.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    hazards_.clear();
+    for (HazardRecord* record = shared_.records.load(std::memory_order_acquire);
+         record != nullptr; record = record->next) {
+      for (auto& hazard : record->hazards) {
+        TaskQueueNode* hazardous_node = hazard.load(std::memory_order_acquire);
+        if (hazardous_node != nullptr) hazards_.push_back(hazardous_node);
+      }
+    }
+    std::sort(hazards_.begin(), hazards_.end());
+    size_t num_kept_nodes = 0;
+    for (TaskQueueNode* retired_node : retired_) {
+      if (std::binary_search(hazards_.begin(), hazards_.end(), retired_node)) {
+        retired_[num_kept_nodes++] = retired_node;
+      } else {
+        retired_node->link = free_nodes_;
+        free_nodes_ = retired_node;
+        ++num_free_nodes_;
+      }
+    }
+    retired_.resize(num_kept_nodes);
+    if (num_free_nodes_ > kMaxFreeNodes) HandOverFreeNodes(kMaxFreeNodes / 2);
+  }
+
+  // Moves all but `num_kept_nodes` free nodes to the shared pool.
+  void HandOverFreeNodes(size_t num_kept_nodes) {
+    if (num_free_nodes_ <= num_kept_nodes) return;
+    TaskQueueNode* first = free_nodes_;
+    TaskQueueNode* last = first;
+    for (size_t i = num_kept_nodes + 1; i < num_free_nodes_; ++i)
+      last = last->link;
+    free_nodes_ = last->link;
+    num_free_nodes_ = num_kept_nodes;
+    PushNodes(&shared_.free_nodes, first, last);
+  }
+
+  // Moves every node of the shared pool to the free list.
+  void TakeFreeNodes() {
+    free_nodes_ =
+        shared_.free_nodes.exchange(nullptr, std::memory_order_acquire);
+    for (TaskQueueNode* node = free_nodes_; node != nullptr; node = node->link)
+      ++num_free_nodes_;
+  }
+
+  SharedState& shared_;
+  HazardRecord* const record_;
+
+  // Nodes retired by the thread, some of which other threads may be reading.
+  std::vector<TaskQueueNode*> retired_;
+
+  // Nodes protected by any thread. Kept to reuse its storage.
+  std::vector<TaskQueueNode*> hazards_;
+
+  // Nodes ready to be reused by the thread.
+  TaskQueueNode* free_nodes_ = nullptr;
+  size_t num_free_nodes_ = 0;
+};  // class ThreadContext
+
+// =============================================================================
+ThreadContext& GetThreadContext() {
+  static thread_local ThreadContext thread_context;
+  return thread_context;
+}
+
+}  // namespace
+
+// =============================================================================
+UnboundedLockFreeTaskQueue::UnboundedLockFreeTaskQueue() {
+  TaskQueueNode* dummy = GetThreadContext().AllocateNode();
+  head_.store(dummy, std::memory_order_relaxed);
+  tail_.store(dummy, std::memory_order_relaxed);
+}
+
+// =============================================================================
+UnboundedLockFreeTaskQueue::~UnboundedLockFreeTaskQueue() {
+  TaskQueueNode* node = head_.load(std::memory_order_relaxed);
+  while (node != nullptr) {
+    TaskQueueNode* next = node->next.load(std::memory_order_relaxed);
+    delete node;
+    node = next;
+  }
+}
+
+// =============================================================================
+void UnboundedLockFreeTaskQueue::Push(Task<> task) {
+  TaskQueueNode* node = GetThreadContext().AllocateNode();
+  node->task = std::move(task);
+  Append(node, node);
+}
+
+// =============================================================================
+void UnboundedLockFreeTaskQueue::PushBulk(Task<>* first, Task<>* last) {
+  if (first == last) return;
+  ThreadContext& context = GetThreadContext();
+  TaskQueueNode* first_node = context.AllocateNode();
+  first_node->task = std::move(*first);
+  TaskQueueNode* last_node = first_node;
+  for (Task<>* task = first + 1; task != last; ++task) {
+    TaskQueueNode* node = context.AllocateNode();
+    node->task = std::move(*task);
+    // Not reachable by other threads until appended.
+    last_node->next.store(node, std::memory_order_relaxed);
+    last_node = node;
+  }
+  Append(first_node, last_node);
+}
+
+// =============================================================================
+void UnboundedLockFreeTaskQueue::Append(TaskQueueNode* first,
+                                        TaskQueueNode* last) {
+  ThreadContext& context = GetThreadContext();
+  for (;;) {
+    TaskQueueNode* tail = tail_.load(std::memory_order_acquire);
+    context.Protect(0, tail);
+    if (tail_.load(std::memory_order_seq_cst) != tail) continue;
+    TaskQueueNode* next = tail->next.load(std::memory_order_acquire);
+    if (tail_.load(std::memory_order_acquire) != tail) continue;
+    if (next != nullptr) {
+      // Another producer linked nodes but did not swing the tail yet. Help it.
+      tail_.compare_exchange_weak(tail, next, std::memory_order_release,
+                                  std::memory_order_relaxed);
+      continue;
+    }
+    if (tail->next.compare_exchange_weak(next, first, std::memory_order_release,
+                                         std::memory_order_relaxed)) {
+      tail_.compare_exchange_strong(tail, last, std::memory_order_release,
+                                    std::memory_order_relaxed);
+      break;
+    }
+  }
+  context.ClearHazards();
+}
+
+// =============================================================================
+Task<> UnboundedLockFreeTaskQueue::Pop() {
+  ThreadContext& context = GetThreadContext();
+  TaskQueueNode* head;
+  TaskQueueNode* next;
+  for (;;) {
+    head = head_.load(std::memory_order_acquire);
+    context.Protect(0, head);
+    if (head_.load(std::memory_order_seq_cst) != head) continue;
+    TaskQueueNode* tail = tail_.load(std::memory_order_acquire);
+    next = head->next.load(std::memory_order_acquire);
+    context.Protect(1, next);
+    if (head_.load(std::memory_order_seq_cst) != head) continue;
+    if (next == nullptr) {
+      // Only the dummy node is left. Queue is empty.
+      context.ClearHazards();
+      return nullptr;
+    }
+    if (head == tail) {
+      // The tail would be left behind the head. Swing it first.
+      tail_.compare_exchange_weak(tail, next, std::memory_order_release,
+                                  std::memory_order_relaxed);
+      continue;
+    }
+    if (head_.compare_exchange_weak(head, next, std::memory_order_seq_cst,
+                                    std::memory_order_relaxed))
+      break;
+  }
+  // The next node is now the dummy, and only this thread reads its task.
+  Task<> task = std::move(next->task);
+  next->task = nullptr;
+  context.ClearHazards();
+  context.Retire(head);
+  return task;
+}
+
+}  // namespace containers
+}  // namespace modcncy
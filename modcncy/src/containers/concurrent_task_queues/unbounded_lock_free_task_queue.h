@@ -0,0 +1,84 @@
+// Copyright 2022 The Modcncy Authors. All rights reserved.
+// Use of this source code is governed by the license found in the LICENSE file.
+// -----------------------------------------------------------------------------
+//
+// The `UnboundedLockFreeTaskQueue` is an unbounded multi-producer
+// multi-consumer FIFO queue of tasks, on top of a singly linked list of nodes,
+// as proposed by Michael and Scott. Its behavior is summarized as follows:
+//
+//   1. The list always starts with a dummy node. `head_` points to it, and the
+//      oldest task is held by the node right after it.
+//
+//   2. Producers link a new node after the last one with a CAS on its `next`,
+//      and then swing `tail_` to it. Consumers swing `head_` to the node right
+//      after the dummy with a CAS, and take its task, so that node becomes the
+//      new dummy.
+//
+//   3. A thread finding `tail_` behind the last node helps swinging it first,
+//      so no thread ever waits for another one.
+//
+// A bulk push links its whole list of nodes at once, and then swings `tail_`
+// to its last node. Steals take a single task, as with the default
+// `StealBatch()`, since the queue does not count its tasks.
+//
+// Nodes are reclaimed with hazard pointers, as proposed by Michael. A thread
+// publishes the nodes it is about to read, and a removed node is only reused
+// once no thread has published it. Reusable nodes are kept in per-thread free
+// lists, and threads holding too many of them hand them over to a shared pool
+// that threads running out of them take from. Thus, steady-state pushes and
+// pops do not allocate any node.
+//
+// -----------------------------------------------------------------------------
+
+#ifndef MODCNCY_SRC_CONTAINERS_CONCURRENT_TASK_QUEUES_UNBOUNDED_LOCK_FREE_TASK_QUEUE_H_  // NOLINT
+#define MODCNCY_SRC_CONTAINERS_CONCURRENT_TASK_QUEUES_UNBOUNDED_LOCK_FREE_TASK_QUEUE_H_  // NOLINT
+
+#include <atomic>
+
+#include "modcncy/include/modcncy/concurrent_task_queue.h"
+#include "modcncy/include/modcncy/global_expressions.h"
+
+namespace modcncy {
+namespace containers {
+
+// A node of the list, shared by every queue so that threads can reuse them.
+struct TaskQueueNode;
+
+class UnboundedLockFreeTaskQueue : public ConcurrentTaskQueue {
+ public:
+  UnboundedLockFreeTaskQueue();
+
+  UnboundedLockFreeTaskQueue(const UnboundedLockFreeTaskQueue&) = delete;
+  UnboundedLockFreeTaskQueue& operator=(const UnboundedLockFreeTaskQueue&) =
+      delete;
+
+  // No other thread may be using the queue.
+  ~UnboundedLockFreeTaskQueue() override;
+
+  // Inserts a task into the queue.
+  void Push(Task<> task) override;
+
+  // Removes a task from the queue. Returns `nullptr` if it is empty.
+  Task<> Pop() override;
+
+  // Inserts many tasks into the queue, linked to the last node at once.
+  void PushBulk(Task<>* first, Task<>* last) override;
+
+ private:
+  // Links the list of nodes from `first` to `last` after the last node.
+  void Append(TaskQueueNode* first, TaskQueueNode* last);
+
+  // Dummy node before the oldest task.
+  std::atomic<TaskQueueNode*> head_;
+
+  // Padding to prevent false sharing.
+  char padding_[kCacheLineSize - sizeof(std::atomic<TaskQueueNode*>)];
+
+  // Last node, or a node right before it.
+  std::atomic<TaskQueueNode*> tail_;
+};  // class UnboundedLockFreeTaskQueue
+
+}  // namespace containers
+}  // namespace modcncy
+
+#endif  // MODCNCY_SRC_CONTAINERS_CONCURRENT_TASK_QUEUES_UNBOUNDED_LOCK_FREE_TASK_QUEUE_H_  // NOLINT
@@ -0,0 +1,153 @@
+// Copyright 2022 The Modcncy Authors. All rights reserved.
+// Use of this source code is governed by the license found in the LICENSE file.
+// -----------------------------------------------------------------------------
+
+#include "modcncy/src/containers/concurrent_task_queues/work_stealing_task_deque.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace modcncy {
+namespace containers {
+namespace {
+
+// =============================================================================
+// Returns the smallest power of two not below `capacity`, and at least 2.
+int64_t RoundUpCapacity(size_t capacity) {
+  int64_t rounded = 2;
+  while (rounded < static_cast<int64_t>(capacity)) rounded <<= 1;
+  return rounded;
+}
+
+}  // namespace
+
+// =============================================================================
+WorkStealingTaskDeque::Ring::Ring(int64_t size, int64_t first_position,
+                                  Ring* previous)
+    : slots(size),
+      mask(size - 1),
+      first_position(first_position),
+      previous(previous) {
+  for (int64_t i = first_position; i < first_position + size; ++i)
+    At(i).free_position.store(i, std::memory_order_relaxed);
+}
+
+// =============================================================================
+WorkStealingTaskDeque::WorkStealingTaskDeque(size_t capacity)
+    : ring_(new Ring(RoundUpCapacity(capacity), /*first_position=*/0,
+                     /*previous=*/nullptr)) {}
+
+// =============================================================================
+WorkStealingTaskDeque::~WorkStealingTaskDeque() {
+  Ring* ring = ring_.load(std::memory_order_relaxed);
+  while (ring != nullptr) {
+    Ring* previous = ring->previous;
+    delete ring;
+    ring = previous;
+  }
+}
+
+// =============================================================================
+void WorkStealingTaskDeque::Push(Task<> task) {
+  const int64_t bottom = bottom_.load(std::memory_order_relaxed);
+  Ring* ring = ring_.load(std::memory_order_relaxed)->Find(bottom);
+  if (ring->At(bottom).free_position.load(std::memory_order_acquire) != bottom)
+    ring = Grow(ring_.load(std::memory_order_relaxed), bottom);
+  ring->At(bottom).task = std::move(task);
+  // Publish the task before the new bottom.
+  bottom_.store(bottom + 1, std::memory_order_release);
+}
+
+// =============================================================================
+void WorkStealingTaskDeque::PushBulk(Task<>* first, Task<>* last) {
+  const int64_t bottom = bottom_.load(std::memory_order_relaxed);
+  int64_t position = bottom;
+  for (Task<>* task = first; task != last; ++task, ++position) {
+    Ring* ring = ring_.load(std::memory_order_relaxed)->Find(position);
+    if (ring->At(position).free_position.load(std::memory_order_acquire) !=
+        position)
+      ring = Grow(ring_.load(std::memory_order_relaxed), position);
+    ring->At(position).task = std::move(*task);
+  }
+  // Publish all tasks before the new bottom.
+  bottom_.store(position, std::memory_order_release);
+}
+
+// =============================================================================
+Task<> WorkStealingTaskDeque::Pop() {
+  const int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+  Ring* ring = ring_.load(std::memory_order_relaxed);
+  bottom_.store(bottom, std::memory_order_relaxed);
+  // Reserve the bottom task before reading the top, so a thief reading the
+  // top later sees the reservation.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  int64_t top = top_.load(std::memory_order_relaxed);
+  if (top > bottom) {
+    // Empty deque.
+    bottom_.store(bottom + 1, std::memory_order_relaxed);
+    return nullptr;
+  }
+  ring = ring->Find(bottom);
+  if (top == bottom) {
+    // Last task. Race the thieves for it.
+    const bool won = top_.compare_exchange_strong(
+        top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+    bottom_.store(bottom + 1, std::memory_order_relaxed);
+    if (!won) return nullptr;
+    // Its position is behind the top now, and never used again.
+    return Take(ring, bottom, /*next_position=*/bottom + ring->mask + 1);
+  }
+  // Its position is the bottom now, where the next push goes.
+  return Take(ring, bottom, /*next_position=*/bottom);
+}
+
+// =============================================================================
+Task<> WorkStealingTaskDeque::Steal() {
+  int64_t top = top_.load(std::memory_order_acquire);
+  // Read the top before the bottom, as the owner does the other way around.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  const int64_t bottom = bottom_.load(std::memory_order_acquire);
+  if (top >= bottom) return nullptr;
+  Ring* ring = ring_.load(std::memory_order_acquire);
+  if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                    std::memory_order_relaxed))
+    return nullptr;
+  ring = ring->Find(top);
+  return Take(ring, top, /*next_position=*/top + ring->mask + 1);
+}
+
+// =============================================================================
+size_t WorkStealingTaskDeque::StealBatch(Task<>* tasks, size_t max_tasks) {
+  const int64_t top = top_.load(std::memory_order_acquire);
+  const int64_t num_pending = bottom_.load(std::memory_order_acquire) - top;
+  // Try at least once, as the count may be stale.
+  const size_t num_tasks = std::min<size_t>(
+      max_tasks, std::max<int64_t>((num_pending + 1) / 2, 1));
+  size_t num_stolen = 0;
+  while (num_stolen < num_tasks) {
+    Task<> task = Steal();
+    if (task == nullptr) break;
+    tasks[num_stolen++] = std::move(task);
+  }
+  return num_stolen;
+}
+
+// =============================================================================
+Task<> WorkStealingTaskDeque::Take(Ring* ring, int64_t position,
+                                   int64_t next_position) {
+  Slot& slot = ring->At(position);
+  Task<> task = std::move(slot.task);
+  slot.free_position.store(next_position, std::memory_order_release);
+  return task;
+}
+
+// =============================================================================
+WorkStealingTaskDeque::Ring* WorkStealingTaskDeque::Grow(Ring* ring,
+                                                         int64_t bottom) {
+  Ring* larger_ring = new Ring(2 * (ring->mask + 1), bottom, ring);
+  ring_.store(larger_ring, std::memory_order_release);
+  return larger_ring;
+}
+
+}  // namespace containers
+}  // namespace modcncy
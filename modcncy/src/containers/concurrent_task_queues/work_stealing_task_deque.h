@@ -0,0 +1,136 @@
+// Copyright 2022 The Modcncy Authors. All rights reserved.
+// Use of this source code is governed by the license found in the LICENSE file.
+// -----------------------------------------------------------------------------
+//
+// The `WorkStealingTaskDeque` is a Chase-Lev work-stealing deque of tasks, with
+// the memory orderings of Le, Pop, Cohen and Zappa Nardelli. Its behavior is
+// summarized as follows:
+//
+//   1. The owner thread pushes and pops tasks at the bottom, in LIFO order, so
+//      it runs the task it pushed last while its data is still cache-hot. It
+//      only writes `bottom_`, without any atomic read-modify-write.
+//
+//   2. Thieves steal tasks at the top, in FIFO order, claiming each of them
+//      with a CAS on `top_`.
+//
+//   3. Owner and thieves only race for the last task, which the owner also
+//      claims with a CAS on `top_`.
+//
+// Tasks are stored by value in a ring buffer of slots, and only moved out of a
+// slot by the thread that claimed its position, so no thread ever reads a task
+// another thread is writing. Every slot holds the position it is free for,
+// which a thread moving a task out of it advances to the same slot on the next
+// lap of the ring buffer. The owner pushing a task into a slot not free yet,
+// because the ring buffer is full or a thief is still moving a task out of it,
+// links a new ring buffer twice as large, for the positions from then on. The
+// old one keeps the tasks at the positions before, so no task is ever moved
+// between ring buffers while thieves may be reading it, and it is only freed
+// along with the deque.
+//
+// A steal losing its CAS to another thread returns `nullptr`, as if the deque
+// were empty, and the thief moves on.
+//
+// A bulk push publishes all its tasks with a single store to `bottom_`. Batch
+// steals still claim their tasks one at a time: claiming many at once would
+// race the owner, which pops all but the last task without any CAS.
+//
+// -----------------------------------------------------------------------------
+
+#ifndef MODCNCY_SRC_CONTAINERS_CONCURRENT_TASK_QUEUES_WORK_STEALING_TASK_DEQUE_H_  // NOLINT
+#define MODCNCY_SRC_CONTAINERS_CONCURRENT_TASK_QUEUES_WORK_STEALING_TASK_DEQUE_H_  // NOLINT
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "modcncy/include/modcncy/concurrent_task_queue.h"
+#include "modcncy/include/modcncy/global_expressions.h"
+
+namespace modcncy {
+namespace containers {
+
+class WorkStealingTaskDeque : public ConcurrentTaskQueue {
+ public:
+  // Starts with room for `capacity` tasks, rounded up to a power of two.
+  explicit WorkStealingTaskDeque(size_t capacity);
+
+  WorkStealingTaskDeque(const WorkStealingTaskDeque&) = delete;
+  WorkStealingTaskDeque& operator=(const WorkStealingTaskDeque&) = delete;
+
+  ~WorkStealingTaskDeque() override;
+
+  // Inserts a task at the bottom. Only called by the owner thread.
+  void Push(Task<> task) override;
+
+  // Removes the newest task, at the bottom. Only called by the owner thread.
+  // Returns `nullptr` if it is empty.
+  Task<> Pop() override;
+
+  // Removes the oldest task, at the top. Called by any other thread. Returns
+  // `nullptr` if it is empty, or if another thread claimed the task first.
+  Task<> Steal() override;
+
+  // Inserts many tasks at the bottom. Only called by the owner thread.
+  void PushBulk(Task<>* first, Task<>* last) override;
+
+  // Removes up to half the tasks, the oldest ones, at the top. Called by any
+  // other thread.
+  size_t StealBatch(Task<>* tasks, size_t max_tasks) override;
+
+ private:
+  // A task, and the position it is free for.
+  struct Slot {
+    std::atomic<int64_t> free_position;
+    Task<> task;
+  };  // struct Slot
+
+  // A ring buffer of slots, for the positions from `first_position` on. The
+  // previous one holds the positions before.
+  struct Ring {
+    Ring(int64_t size, int64_t first_position, Ring* previous);
+
+    // Returns the ring buffer holding `position`.
+    Ring* Find(int64_t position) {
+      Ring* ring = this;
+      while (position < ring->first_position) ring = ring->previous;
+      return ring;
+    }
+
+    // Returns the slot of `position`, which must be held by this ring buffer.
+    Slot& At(int64_t position) { return slots[position & mask]; }
+
+    std::vector<Slot> slots;
+    const int64_t mask;
+    const int64_t first_position;
+    Ring* const previous;
+  };  // struct Ring
+
+  // Moves the task out of the slot of `position` in `ring`, and frees the slot
+  // for `next_position`.
+  static Task<> Take(Ring* ring, int64_t position, int64_t next_position);
+
+  // Links a ring buffer twice as large as `ring`, for the positions from
+  // `bottom` on, and returns it. Only called by the owner thread.
+  Ring* Grow(Ring* ring, int64_t bottom);
+
+  // Current ring buffer.
+  std::atomic<Ring*> ring_;
+
+  // Padding to prevent false sharing.
+  char padding_[kCacheLineSize];
+
+  // Position of the oldest task. Written by thieves and by the owner.
+  std::atomic<int64_t> top_{0};
+
+  // Padding to prevent false sharing.
+  char padding2_[kCacheLineSize - sizeof(std::atomic<int64_t>)];
+
+  // Position past the newest task. Only written by the owner.
+  std::atomic<int64_t> bottom_{0};
+};  // class WorkStealingTaskDeque
+
+}  // namespace containers
+}  // namespace modcncy
+
+#endif  // MODCNCY_SRC_CONTAINERS_CONCURRENT_TASK_QUEUES_WORK_STEALING_TASK_DEQUE_H_  // NOLINT
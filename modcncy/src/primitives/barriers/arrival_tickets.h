@@ -0,0 +1,52 @@
+// Copyright 2022 The Modcncy Authors. All rights reserved.
+// Use of this source code is governed by the license found in the LICENSE file.
+// -----------------------------------------------------------------------------
+//
+// The `ArrivalTickets` hand out thread identities to the barriers that rely on
+// them, whenever the calling threads do not provide their own. Its behavior is
+// summarized as follows:
+//
+//   1. Each thread arriving at the barrier takes the next ticket, which is its
+//      identity in the range [0, num_threads) for the current synchronization.
+//
+//   2. The thread taking the last ticket resets the tickets for the next
+//      synchronization. No other thread can take a ticket in the meantime,
+//      since all of them are still waiting at the barrier.
+//
+// Note that this reintroduces a central counter. Callers that care about
+// scalability should provide their own thread identities instead.
+//
+// -----------------------------------------------------------------------------
+
+#ifndef MODCNCY_SRC_PRIMITIVES_BARRIERS_ARRIVAL_TICKETS_H_
+#define MODCNCY_SRC_PRIMITIVES_BARRIERS_ARRIVAL_TICKETS_H_
+
+#include <atomic>
+
+#include "modcncy/include/modcncy/global_expressions.h"
+
+namespace modcncy {
+namespace primitives {
+
+class ArrivalTickets {
+ public:
+  // Returns a unique thread identity in the range [0, num_threads).
+  int Next(int num_threads) {
+    const int ticket = next_ticket_.fetch_add(1, std::memory_order_relaxed);
+    if (ticket >= num_threads - 1)
+      next_ticket_.store(0, std::memory_order_relaxed);
+    return ticket;
+  }
+
+ private:
+  // Next ticket to be handed out.
+  std::atomic<int> next_ticket_{0};
+
+  // Padding to prevent false sharing.
+  char padding_[kCacheLineSize - sizeof(std::atomic<int>)];
+};  // class ArrivalTickets
+
+}  // namespace primitives
+}  // namespace modcncy
+
+#endif  // MODCNCY_SRC_PRIMITIVES_BARRIERS_ARRIVAL_TICKETS_H_
@@ -4,21 +4,104 @@
 
 #include "modcncy/include/modcncy/barrier.h"
 
+#include <utility>
+
 #include "modcncy/src/primitives/barriers/central_sense_counter_barrier.h"
 #include "modcncy/src/primitives/barriers/central_step_counter_barrier.h"
+#include "modcncy/src/primitives/barriers/combining_tree_barrier.h"
+#include "modcncy/src/primitives/barriers/dissemination_barrier.h"
+#include "modcncy/src/primitives/barriers/numa_hierarchical_barrier.h"
+#include "modcncy/src/primitives/barriers/spin_then_park_barrier.h"
+#include "modcncy/src/primitives/barriers/static_tree_barrier.h"
+#include "modcncy/src/primitives/barriers/tournament_barrier.h"
+#include "modcncy/src/topology/cpu_topology.h"
 
 namespace modcncy {
+namespace {
+
+// Maximum number of threads served by a central counter barrier.
+constexpr int kMaxCentralBarrierThreads = 8;
+
+// =============================================================================
+// Selects the barrier that best fits `num_threads` threads on this host:
+//
+//   + If threads outnumber the online CPUs, some of them will be descheduled
+//     while waiting, so they should park instead of spinning.
+//
+//   + A handful of threads within a single socket are served best by the
+//     simplest central counter barrier.
+//
+//   + Threads spread over several sockets should keep most of the traffic
+//     within their own socket.
+//
+//   + Otherwise, a combining tree spreads the arrivals over many counters.
+BarrierType SelectBarrierType(int num_threads) {
+  const topology::CpuTopology cpu_topology = topology::ReadCpuTopology();
+  if (num_threads <= 0) num_threads = cpu_topology.num_cpus;
+  if (num_threads > cpu_topology.num_cpus)
+    return BarrierType::kSpinThenParkBarrier;
+  if (num_threads <= kMaxCentralBarrierThreads &&
+      cpu_topology.num_sockets == 1)
+    return BarrierType::kCentralSenseCounterBarrier;
+  if (cpu_topology.num_sockets > 1)
+    return BarrierType::kNumaHierarchicalBarrier;
+  return BarrierType::kCombiningTreeBarrier;
+}
+
+}  // namespace
 
 // =============================================================================
 // Factory method. Creates a new `Barrier` object based on its type.
-Barrier* Barrier::Create(BarrierType type) {
+Barrier* Barrier::Create(BarrierType type, int num_threads) {
   switch (type) {
     case BarrierType::kCentralSenseCounterBarrier:
       return new primitives::CentralSenseCounterBarrier();
     case BarrierType::kCentralStepCounterBarrier:
       return new primitives::CentralStepCounterBarrier();
+    case BarrierType::kCombiningTreeBarrier:
+      return new primitives::CombiningTreeBarrier();
+    case BarrierType::kDisseminationBarrier:
+      return new primitives::DisseminationBarrier();
+    case BarrierType::kTournamentBarrier:
+      return new primitives::TournamentBarrier();
+    case BarrierType::kStaticTreeBarrier:
+      return new primitives::StaticTreeBarrier();
+    case BarrierType::kSpinThenParkBarrier:
+      return new primitives::SpinThenParkBarrier();
+    case BarrierType::kAdaptive:
+      return Create(SelectBarrierType(num_threads));
+    case BarrierType::kNumaHierarchicalBarrier:
+      return new primitives::NumaHierarchicalBarrier();
   }
   return nullptr;
 }
 
+// =============================================================================
+// By default, barriers do not make use of the identity of the calling thread.
+void Barrier::Wait(int num_threads, int /*thread_id*/,
+                   std::function<void()> policy) {
+  Wait(num_threads, policy);
+}
+
+// =============================================================================
+// By default, barriers do not split the synchronization. Arriving completes it.
+Barrier::Token Barrier::Arrive(int num_threads) {
+  Wait(num_threads);
+  return Token{0, 0};
+}
+
+// =============================================================================
+// By default, the synchronization is already completed on arrival.
+void Barrier::Wait(Token /*token*/, std::function<void()> /*policy*/) {}
+
+// =============================================================================
+void Barrier::SetCompletion(std::function<void()> completion) {
+  completion_ = std::move(completion);
+}
+
+// =============================================================================
+void Barrier::SetEventCount(EventCount* event_count) {
+  event_count_ = event_count;
+}
+
 }  // namespace modcncy
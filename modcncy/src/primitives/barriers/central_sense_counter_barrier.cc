@@ -4,23 +4,26 @@
 
 #include "modcncy/src/primitives/barriers/central_sense_counter_barrier.h"
 
+#include <utility>
+
 namespace modcncy {
 namespace primitives {
 
 // =============================================================================
 void CentralSenseCounterBarrier::Wait(int num_threads,
                                       std::function<void()> policy) {
-  const unsigned my_sense = sense_.load(std::memory_order_relaxed);
-  if (spinning_threads_.fetch_add(1, std::memory_order_acq_rel) <
-      num_threads - 1) {
-    // Wait until last thread arrives.
-    while (sense_.load(std::memory_order_acquire) == my_sense) policy();
-  } else {
-    // Last thread enters the barrier.
-    // Reset number of spinning threads and toggle the global sense.
-    spinning_threads_.store(0, std::memory_order_relaxed);
-    sense_.store(~my_sense, std::memory_order_release);
-  }
+  barrier_.Wait(num_threads, std::move(policy));
+}
+
+// =============================================================================
+Barrier::Token CentralSenseCounterBarrier::Arrive(int num_threads) {
+  return barrier_.Arrive(num_threads);
+}
+
+// =============================================================================
+void CentralSenseCounterBarrier::Wait(Token token,
+                                      std::function<void()> policy) {
+  barrier_.Wait(token, std::move(policy));
 }
 
 }  // namespace primitives
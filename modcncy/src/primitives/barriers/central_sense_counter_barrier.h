@@ -10,38 +10,60 @@
 //   1. When a thread arrives at the barrier, it increases the shared counter
 //      and starts spinning on the global sense flag.
 //
-//   2. When the last thread arrives at the barrier, it resets the shared
-//      counter and moves all current spinning threads out of the barrier by
-//      flipping the global sense flag.
+//   2. When the last thread arrives at the barrier, it runs the completion
+//      function, if any, resets the shared counter and moves all current
+//      spinning threads out of the barrier by flipping the global sense flag.
+//
+// The spinning can be deferred with the split-phase interface. `Arrive()` only
+// increases the shared counter (or, for the last thread, releases the others)
+// and returns the observed sense as a token to spin on with `Wait()`.
+//
+// It wraps the header-only `CentralSenseCounterBarrierT`, instantiated with a
+// wait policy given at runtime.
 //
 // -----------------------------------------------------------------------------
 
 #ifndef MODCNCY_SRC_PRIMITIVES_BARRIERS_CENTRAL_SENSE_COUNTER_BARRIER_H_
 #define MODCNCY_SRC_PRIMITIVES_BARRIERS_CENTRAL_SENSE_COUNTER_BARRIER_H_
 
-#include <atomic>
+#include <functional>
 
 #include "modcncy/include/modcncy/barrier.h"
-#include "modcncy/include/modcncy/global_expressions.h"
+#include "modcncy/include/modcncy/templated_barrier.h"
 
 namespace modcncy {
 namespace primitives {
 
 class CentralSenseCounterBarrier : public Barrier {
  public:
+  using Barrier::Wait;
+
   // A thread must wait here until all threads reach this point.
   void Wait(int num_threads, std::function<void()> policy) override;
 
+  // A thread signals its arrival without waiting for all other threads.
+  Token Arrive(int num_threads) override;
+
+  // A thread must wait here until all threads arrive at the `token` phase.
+  void Wait(Token token, std::function<void()> policy) override;
+
  private:
-  // Number of threads spinning at the barrier.
-  std::atomic<int> spinning_threads_{0};
+  // Runs the completion function of the barrier.
+  struct RunCompletion {
+    void operator()() const { barrier->Complete(); }
+    CentralSenseCounterBarrier* barrier;
+  };  // struct RunCompletion
 
-  // Padding to prevent false sharing.
-  char padding_[kCacheLineSize - sizeof(std::atomic<int>)];
+  // Notifies the event count of the barrier.
+  struct RunNotification {
+    void operator()() const { barrier->Notify(); }
+    CentralSenseCounterBarrier* barrier;
+  };  // struct RunNotification
 
-  // Global sense flag.
-  // The barrier is reusable since it flips between states.
-  std::atomic<unsigned> sense_{0};
+  // Barrier implementation, waiting with a policy given at runtime.
+  CentralSenseCounterBarrierT<std::function<void()>, RunCompletion,
+                              RunNotification>
+      barrier_{RunCompletion{this}, RunNotification{this}};
 };  // class CentralSenseCounterBarrier
 
 }  // namespace primitives
@@ -4,7 +4,7 @@
 
 #include "modcncy/src/primitives/barriers/central_step_counter_barrier.h"
 
-#include "modcncy/include/modcncy/wait_policy.h"
+#include <utility>
 
 namespace modcncy {
 namespace primitives {
@@ -12,17 +12,18 @@ namespace primitives {
 // =============================================================================
 void CentralStepCounterBarrier::Wait(int num_threads,
                                      std::function<void()> policy) {
-  const unsigned current_step = step_.load(std::memory_order_relaxed);
-  if (spinning_threads_.fetch_add(1, std::memory_order_acq_rel) <
-      num_threads - 1) {
-    // Wait until last thread arrives.
-    while (step_.load(std::memory_order_acquire) == current_step) policy();
-  } else {
-    // Last thread enters the barrier.
-    // Reset number of spinning threads and increase the step.
-    spinning_threads_.store(0, std::memory_order_relaxed);
-    step_.fetch_add(1, std::memory_order_release);
-  }
+  barrier_.Wait(num_threads, std::move(policy));
+}
+
+// =============================================================================
+Barrier::Token CentralStepCounterBarrier::Arrive(int num_threads) {
+  return barrier_.Arrive(num_threads);
+}
+
+// =============================================================================
+void CentralStepCounterBarrier::Wait(Token token,
+                                     std::function<void()> policy) {
+  barrier_.Wait(token, std::move(policy));
 }
 
 }  // namespace primitives
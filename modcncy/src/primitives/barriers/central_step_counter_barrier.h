@@ -11,38 +11,60 @@
 //      and starts spinning on the number of barrier synchronizations completed
 //      so far.
 //
-//   2. When the last thread arrives at the barrier, it resets the shared
-//      counter and moves all current spinning threads out of the barrier by
-//      increasing the current step.
+//   2. When the last thread arrives at the barrier, it runs the completion
+//      function, if any, resets the shared counter and moves all current
+//      spinning threads out of the barrier by increasing the current step.
+//
+// The spinning can be deferred with the split-phase interface. `Arrive()` only
+// increases the shared counter (or, for the last thread, releases the others)
+// and returns the observed step as a token to spin on with `Wait()`.
+//
+// It wraps the header-only `CentralStepCounterBarrierT`, instantiated with a
+// wait policy given at runtime.
 //
 // -----------------------------------------------------------------------------
 
 #ifndef MODCNCY_SRC_PRIMITIVES_BARRIERS_CENTRAL_STEP_COUNTER_BARRIER_H_
 #define MODCNCY_SRC_PRIMITIVES_BARRIERS_CENTRAL_STEP_COUNTER_BARRIER_H_
 
-#include <atomic>
+#include <functional>
 
 #include "modcncy/include/modcncy/barrier.h"
-#include "modcncy/include/modcncy/global_expressions.h"
+#include "modcncy/include/modcncy/templated_barrier.h"
 
 namespace modcncy {
 namespace primitives {
 
 class CentralStepCounterBarrier : public Barrier {
  public:
+  using Barrier::Wait;
+
   // A thread must wait here until all threads reach this point.
   void Wait(int num_threads, std::function<void()> policy) override;
 
+  // A thread signals its arrival without waiting for all other threads.
+  Token Arrive(int num_threads) override;
+
+  // A thread must wait here until all threads arrive at the `token` phase.
+  void Wait(Token token, std::function<void()> policy) override;
+
  private:
-  // Number of threads spinning at the barrier.
-  std::atomic<int> spinning_threads_{0};
+  // Runs the completion function of the barrier.
+  struct RunCompletion {
+    void operator()() const { barrier->Complete(); }
+    CentralStepCounterBarrier* barrier;
+  };  // struct RunCompletion
 
-  // Padding to prevent false sharing.
-  char padding_[kCacheLineSize - sizeof(std::atomic<int>)];
+  // Notifies the event count of the barrier.
+  struct RunNotification {
+    void operator()() const { barrier->Notify(); }
+    CentralStepCounterBarrier* barrier;
+  };  // struct RunNotification
 
-  // Number of barrier synchronizations completed so far.
-  // The barrier is reusable since unsigned data type wraps around the overflow.
-  std::atomic<unsigned> step_{0};
+  // Barrier implementation, waiting with a policy given at runtime.
+  CentralStepCounterBarrierT<std::function<void()>, RunCompletion,
+                             RunNotification>
+      barrier_{RunCompletion{this}, RunNotification{this}};
 };  // class CentralStepCounterBarrier
 
 }  // namespace primitives
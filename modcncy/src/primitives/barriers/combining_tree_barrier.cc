@@ -0,0 +1,109 @@
+// Copyright 2022 The Modcncy Authors. All rights reserved.
+// Use of this source code is governed by the license found in the LICENSE file.
+// -----------------------------------------------------------------------------
+
+#include "modcncy/src/primitives/barriers/combining_tree_barrier.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace modcncy {
+namespace primitives {
+namespace {
+
+// =============================================================================
+// Returns the leaf where the calling thread starts looking for a free slot.
+// Consecutive threads start in different leaves to spread the arrivals.
+unsigned LeafHint() {
+  static std::atomic<unsigned> next_hint{0};
+  static thread_local const unsigned hint =
+      next_hint.fetch_add(1, std::memory_order_relaxed);
+  return hint;
+}
+
+// =============================================================================
+// Returns the total number of nodes of a tree with `num_leaves` leaves.
+int NumNodes(int num_leaves, int fan_in) {
+  int num_nodes = num_leaves;
+  while (num_leaves > 1) {
+    num_leaves = (num_leaves + fan_in - 1) / fan_in;
+    num_nodes += num_leaves;
+  }
+  return num_nodes;
+}
+
+}  // namespace
+
+// =============================================================================
+CombiningTreeBarrier::CombiningTreeBarrier(int fan_in)
+    : fan_in_(std::max(fan_in, 2)) {}
+
+// =============================================================================
+CombiningTreeBarrier::Arrival CombiningTreeBarrier::Arrive(Node* node, int size,
+                                                           unsigned step) {
+  const uint64_t tag = static_cast<uint64_t>(step) << 32;
+  uint64_t state = node->state.load(std::memory_order_relaxed);
+  for (;;) {
+    // A node tagged with a previous step is empty.
+    const uint64_t count = (state >> 32) == step ? state & 0xFFFFFFFF : 0;
+    if (count == static_cast<uint64_t>(size)) return Arrival::kFull;
+    if (node->state.compare_exchange_weak(state, tag | (count + 1),
+                                          std::memory_order_acq_rel,
+                                          std::memory_order_relaxed)) {
+      return count + 1 == static_cast<uint64_t>(size) ? Arrival::kLast
+                                                      : Arrival::kArrived;
+    }
+  }
+}
+
+// =============================================================================
+void CombiningTreeBarrier::Wait(int num_threads, std::function<void()> policy) {
+  Wait(Arrive(num_threads), std::move(policy));
+}
+
+// =============================================================================
+Barrier::Token CombiningTreeBarrier::Arrive(int num_threads) {
+  const unsigned my_step = step_.load(std::memory_order_relaxed);
+  num_threads = std::max(num_threads, 1);
+  int width = (num_threads + fan_in_ - 1) / fan_in_;  // Nodes in this level.
+  Node* level = nodes_.Get(NumNodes(width, fan_in_));
+
+  // Claim a slot in any leaf that is not full yet.
+  int index = LeafHint() % width;
+  int size = std::min(fan_in_, num_threads - index * fan_in_);
+  Arrival arrival;
+  while ((arrival = Arrive(&level[index], size, my_step)) == Arrival::kFull) {
+    index = (index + 1) % width;
+    size = std::min(fan_in_, num_threads - index * fan_in_);
+  }
+
+  // The last thread arriving at a node moves up to its parent.
+  while (arrival == Arrival::kLast) {
+    if (width == 1) {
+      // Last thread enters the barrier.
+      // Run the completion function, increase the step to release all
+      // spinning threads and notify parked ones.
+      Complete();
+      step_.store(my_step + 1, std::memory_order_release);
+      Notify();
+      break;
+    }
+    const int children = width;
+    level += width;
+    width = (width + fan_in_ - 1) / fan_in_;
+    index /= fan_in_;
+    size = std::min(fan_in_, children - index * fan_in_);
+    arrival = Arrive(&level[index], size, my_step);
+  }
+  return Token{my_step, 0};
+}
+
+// =============================================================================
+void CombiningTreeBarrier::Wait(Token token, std::function<void()> policy) {
+  // Wait until last thread arrives.
+  WatchAddress(&policy, &step_);
+  while (step_.load(std::memory_order_acquire) == token.phase) policy();
+}
+
+}  // namespace primitives
+}  // namespace modcncy
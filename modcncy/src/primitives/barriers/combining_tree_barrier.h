@@ -0,0 +1,95 @@
+// Copyright 2022 The Modcncy Authors. All rights reserved.
+// Use of this source code is governed by the license found in the LICENSE file.
+// -----------------------------------------------------------------------------
+//
+// The `CombiningTreeBarrier` is a software combining tree barrier where the
+// arrivals are distributed among the nodes of a tree of counters with a
+// configurable fan-in, instead of funneling all of them through one central
+// counter. Each node lives in its own cache line. Its behavior is summarized as
+// follows:
+//
+//   1. When a thread arrives at the barrier, it claims a free slot in one of
+//      the leaves of the tree and starts spinning on the global step.
+//
+//   2. The thread that fills a node moves up and claims a slot in its parent
+//      node. Therefore, at most `fan_in` threads ever contend on a node.
+//
+//   3. When the thread filling the root node arrives, it moves all current
+//      spinning threads out of the barrier by increasing the global step.
+//
+// The spinning can be deferred with the split-phase interface. `Arrive()` goes
+// up the tree (or, for the last thread, releases the others) and returns the
+// observed step as a token to spin on with `Wait()`.
+//
+// The shape of the tree depends on the number of threads passed to `Wait()`.
+// Nodes are tagged with the step they were last used in, so they never need to
+// be reset and the barrier is reusable with a different number of threads.
+//
+// -----------------------------------------------------------------------------
+
+#ifndef MODCNCY_SRC_PRIMITIVES_BARRIERS_COMBINING_TREE_BARRIER_H_
+#define MODCNCY_SRC_PRIMITIVES_BARRIERS_COMBINING_TREE_BARRIER_H_
+
+#include <atomic>
+#include <cstdint>
+
+#include "modcncy/include/modcncy/barrier.h"
+#include "modcncy/include/modcncy/global_expressions.h"
+#include "modcncy/src/primitives/barriers/growing_array.h"
+
+namespace modcncy {
+namespace primitives {
+
+class CombiningTreeBarrier : public Barrier {
+ public:
+  // Default maximum number of arrivals combined by a node of the tree.
+  static constexpr int kDefaultFanIn = 4;
+
+  explicit CombiningTreeBarrier(int fan_in = kDefaultFanIn);
+
+  using Barrier::Wait;
+
+  // A thread must wait here until all threads reach this point.
+  void Wait(int num_threads, std::function<void()> policy) override;
+
+  // A thread signals its arrival without waiting for all other threads.
+  Token Arrive(int num_threads) override;
+
+  // A thread must wait here until all threads arrive at the `token` phase.
+  void Wait(Token token, std::function<void()> policy) override;
+
+ private:
+  // Node of the combining tree.
+  // The upper half of `state` is the step of the last arrival and the lower
+  // half is the number of arrivals in that step.
+  struct alignas(kCacheLineSize) Node {
+    std::atomic<uint64_t> state{0};
+  };  // struct Node
+
+  // Result of arriving at a node.
+  enum class Arrival { kFull, kArrived, kLast };
+
+  // Tries to claim one of the `size` slots of `node` during `step`.
+  static Arrival Arrive(Node* node, int size, unsigned step);
+
+  // Maximum number of arrivals combined by a node of the tree.
+  const int fan_in_;
+
+  // Padding to prevent false sharing.
+  char padding_[kCacheLineSize - sizeof(int)];
+
+  // Number of barrier synchronizations completed so far.
+  // The barrier is reusable since unsigned data type wraps around the overflow.
+  std::atomic<unsigned> step_{0};
+
+  // Padding to prevent false sharing.
+  char padding2_[kCacheLineSize - sizeof(std::atomic<unsigned>)];
+
+  // Nodes of the tree stored level by level, starting from the leaves.
+  GrowingArray<Node> nodes_;
+};  // class CombiningTreeBarrier
+
+}  // namespace primitives
+}  // namespace modcncy
+
+#endif  // MODCNCY_SRC_PRIMITIVES_BARRIERS_COMBINING_TREE_BARRIER_H_
@@ -0,0 +1,57 @@
+// Copyright 2022 The Modcncy Authors. All rights reserved.
+// Use of this source code is governed by the license found in the LICENSE file.
+// -----------------------------------------------------------------------------
+
+#include "modcncy/src/primitives/barriers/dissemination_barrier.h"
+
+namespace modcncy {
+namespace primitives {
+
+// =============================================================================
+void DisseminationBarrier::Wait(int num_threads, std::function<void()> policy) {
+  Wait(num_threads, /*thread_id=*/tickets_.Next(num_threads), policy);
+}
+
+// =============================================================================
+void DisseminationBarrier::Wait(int num_threads, int thread_id,
+                                std::function<void()> policy) {
+  Flags* flags = flags_.Get(num_threads);
+  Flags& my_flags = flags[thread_id];
+
+  // Number of rounds is ceil(log2(num_threads)).
+  int num_rounds = 0;
+  while (num_rounds < kMaxRounds - 1 && (1 << num_rounds) < num_threads)
+    ++num_rounds;
+
+  // With a completion function, all rounds are gone through twice.
+  const int num_passes = HasCompletion() ? 2 : 1;
+
+  // Account for the awaited signals before signaling anyone. Thus, the next
+  // holder of this thread identity is guaranteed to observe them.
+  unsigned awaited[2 * kMaxRounds];
+  for (int round = 0; round < num_passes * num_rounds; ++round)
+    awaited[round] = ++my_flags.awaited[round % num_rounds];
+
+  for (int pass = 0; pass < num_passes; ++pass) {
+    // Everyone has arrived once the first pass is over. The thread with
+    // identity 0 runs the completion function before releasing anyone.
+    if (pass == 1 && thread_id == 0) Complete();
+    for (int round = 0; round < num_rounds; ++round) {
+      // Signal my partner of this round.
+      const int partner = (thread_id + (1 << round)) % num_threads;
+      flags[partner].signals[round].fetch_add(1, std::memory_order_release);
+      Notify();
+      // Wait until the signal of this round arrives. A partner already in a
+      // later pass or synchronization may have signaled more times.
+      const unsigned awaited_signals = awaited[pass * num_rounds + round];
+      WatchAddress(&policy, &my_flags.signals[round]);
+      while (static_cast<int>(
+                 my_flags.signals[round].load(std::memory_order_acquire) -
+                 awaited_signals) < 0)
+        policy();
+    }
+  }
+}
+
+}  // namespace primitives
+}  // namespace modcncy
@@ -0,0 +1,76 @@
+// Copyright 2022 The Modcncy Authors. All rights reserved.
+// Use of this source code is governed by the license found in the LICENSE file.
+// -----------------------------------------------------------------------------
+//
+// The `DisseminationBarrier` is a barrier implementation without any central
+// hot spot, where each thread spins on its own flags and notifications travel
+// through ceil(log2(num_threads)) rounds. Its behavior is summarized as
+// follows:
+//
+//   1. In round `r`, the thread with identity `i` signals its partner with
+//      identity `(i + 2^r) % num_threads` and waits for the signal of the
+//      thread with identity `(i - 2^r) % num_threads`.
+//
+//   2. After the last round, every thread has transitively heard from all other
+//      threads, so all of them leave the barrier.
+//
+// Flags are counters of the signals received in each round, so they never need
+// to be reset and the barrier is reusable with a different number of threads.
+// Each thread keeps its flags in its own padded block of cache lines.
+//
+// No single thread learns that all others have arrived before they leave. Thus,
+// if a completion function is set, threads go through all rounds twice, and
+// the thread with identity 0 runs it before its first signal of the second
+// pass. No thread leaves before hearing from it, and so before it completes.
+//
+// Threads that do not provide their identity take one from a central ticket,
+// which brings back a shared counter on the way in.
+//
+// -----------------------------------------------------------------------------
+
+#ifndef MODCNCY_SRC_PRIMITIVES_BARRIERS_DISSEMINATION_BARRIER_H_
+#define MODCNCY_SRC_PRIMITIVES_BARRIERS_DISSEMINATION_BARRIER_H_
+
+#include <atomic>
+
+#include "modcncy/include/modcncy/barrier.h"
+#include "modcncy/include/modcncy/global_expressions.h"
+#include "modcncy/src/primitives/barriers/arrival_tickets.h"
+#include "modcncy/src/primitives/barriers/growing_array.h"
+
+namespace modcncy {
+namespace primitives {
+
+class DisseminationBarrier : public Barrier {
+ public:
+  // A thread must wait here until all threads reach this point.
+  void Wait(int num_threads, std::function<void()> policy) override;
+
+  // A thread must wait here until all threads reach this point.
+  void Wait(int num_threads, int thread_id,
+            std::function<void()> policy) override;
+
+ private:
+  // Enough rounds for any positive `int` number of threads.
+  static constexpr int kMaxRounds = 32;
+
+  // Per-thread flags.
+  struct alignas(kCacheLineSize) Flags {
+    // Number of signals received from the partners of each round.
+    std::atomic<unsigned> signals[kMaxRounds];
+    // Number of signals awaited in each round. Owned by the current holder of
+    // the thread identity, and only updated before signaling any partner.
+    unsigned awaited[kMaxRounds];
+  };  // struct Flags
+
+  // Identities for the threads that do not provide one.
+  ArrivalTickets tickets_;
+
+  // Flags of each thread identity.
+  GrowingArray<Flags> flags_;
+};  // class DisseminationBarrier
+
+}  // namespace primitives
+}  // namespace modcncy
+
+#endif  // MODCNCY_SRC_PRIMITIVES_BARRIERS_DISSEMINATION_BARRIER_H_
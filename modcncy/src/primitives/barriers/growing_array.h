@@ -0,0 +1,103 @@
+// Copyright 2022 The Modcncy Authors. All rights reserved.
+// Use of this source code is governed by the license found in the LICENSE file.
+// -----------------------------------------------------------------------------
+//
+// The `GrowingArray` is a helper container for the barriers whose internal
+// state depends on the number of participating threads, which is only known
+// when `Wait()` is called. Its behavior is summarized as follows:
+//
+//   1. `Get(size)` returns an array of at least `size` elements. Elements are
+//      aligned to their natural alignment, so cache line aligned types never
+//      share a cache line with other elements.
+//
+//   2. If the current array is too small, a bigger one is allocated and
+//      published with a single compare-and-swap. Concurrent callers asking for
+//      the same `size` always observe the same array.
+//
+//   3. Arrays are never moved nor freed while the container is alive. Retired
+//      arrays are only released on destruction, so threads still spinning on
+//      an older array remain safe.
+//
+// -----------------------------------------------------------------------------
+
+#ifndef MODCNCY_SRC_PRIMITIVES_BARRIERS_GROWING_ARRAY_H_
+#define MODCNCY_SRC_PRIMITIVES_BARRIERS_GROWING_ARRAY_H_
+
+#include <stdlib.h>
+
+#include <atomic>
+#include <new>
+
+namespace modcncy {
+namespace primitives {
+
+template <typename T>
+class GrowingArray {
+ public:
+  GrowingArray() = default;
+  GrowingArray(const GrowingArray&) = delete;
+  GrowingArray& operator=(const GrowingArray&) = delete;
+
+  ~GrowingArray() {
+    Block* block = block_.load(std::memory_order_relaxed);
+    while (block != nullptr) {
+      Block* previous = block->previous;
+      for (int i = 0; i < block->size; ++i) block->data[i].~T();
+      free(block->data);
+      delete block;
+      block = previous;
+    }
+  }
+
+  // Returns an array of at least `size` value-initialized elements.
+  T* Get(int size) {
+    Block* block = block_.load(std::memory_order_acquire);
+    while (block == nullptr || block->size < size) {
+      Block* bigger = NewBlock(/*size=*/Capacity(size), /*previous=*/block);
+      if (block_.compare_exchange_strong(block, bigger,
+                                         std::memory_order_acq_rel,
+                                         std::memory_order_acquire)) {
+        return bigger->data;
+      }
+      // Some other thread published its array first. Use that one instead.
+      for (int i = 0; i < bigger->size; ++i) bigger->data[i].~T();
+      free(bigger->data);
+      delete bigger;
+    }
+    return block->data;
+  }
+
+ private:
+  // Array of elements plus the chain of retired arrays.
+  struct Block {
+    T* data;
+    int size;
+    Block* previous;
+  };
+
+  // Rounds `size` up to a power of 2 to amortize the number of allocations.
+  static int Capacity(int size) {
+    int capacity = 1;
+    while (capacity < size) capacity <<= 1;
+    return capacity;
+  }
+
+  static Block* NewBlock(int size, Block* previous) {
+    void* memory = nullptr;
+    const size_t alignment =
+        alignof(T) < sizeof(void*) ? sizeof(void*) : alignof(T);
+    if (posix_memalign(&memory, alignment, size * sizeof(T)) != 0)
+      throw std::bad_alloc();
+    T* data = static_cast<T*>(memory);
+    for (int i = 0; i < size; ++i) new (&data[i]) T();
+    return new Block{data, size, previous};
+  }
+
+  // Most recently published array.
+  std::atomic<Block*> block_{nullptr};
+};  // class GrowingArray
+
+}  // namespace primitives
+}  // namespace modcncy
+
+#endif  // MODCNCY_SRC_PRIMITIVES_BARRIERS_GROWING_ARRAY_H_
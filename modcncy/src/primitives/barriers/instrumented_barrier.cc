@@ -0,0 +1,321 @@
+// Copyright 2022 The Modcncy Authors. All rights reserved.
+// Use of this source code is governed by the license found in the LICENSE file.
+// -----------------------------------------------------------------------------
+
+#include "modcncy/include/modcncy/instrumented_barrier.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT(build/c++11)
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <map>
+#include <mutex>  // NOLINT(build/c++11)
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace modcncy {
+namespace {
+
+// =============================================================================
+// Returns the current time of the steady clock, in nanoseconds.
+int64_t Now() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// =============================================================================
+// Returns a number of the calling thread unique among the live threads. The
+// numbers of exited threads are reused, smallest first, so threads started for
+// every run of an algorithm keep taking the same numbers.
+int ThreadNumber() {
+  static std::mutex* mutex = new std::mutex();
+  static std::set<int>* free_numbers = new std::set<int>();
+  static int num_numbers = 0;
+  struct Holder {
+    Holder() {
+      std::lock_guard<std::mutex> lock(*mutex);
+      if (free_numbers->empty()) {
+        number = num_numbers++;
+      } else {
+        number = *free_numbers->begin();
+        free_numbers->erase(free_numbers->begin());
+      }
+    }
+    ~Holder() {
+      std::lock_guard<std::mutex> lock(*mutex);
+      free_numbers->insert(number);
+    }
+    int number;
+  };  // struct Holder
+  static thread_local Holder holder;
+  return holder.number;
+}
+
+// =============================================================================
+// Returns the bucket of a `duration`. Durations below 4 have a bucket each, and
+// every power of two above is split in 4 buckets.
+int BucketOf(int64_t duration) {
+  if (duration < 4) return duration < 0 ? 0 : static_cast<int>(duration);
+  const int exponent = 63 - __builtin_clzll(static_cast<uint64_t>(duration));
+  const int sub_bucket = static_cast<int>(duration >> (exponent - 2)) & 3;
+  return 4 * (exponent - 1) + sub_bucket;
+}
+
+// =============================================================================
+// Returns the smallest duration falling in `bucket`.
+int64_t LowerBoundOf(int bucket) {
+  if (bucket < 4) return bucket;
+  const int exponent = bucket / 4 + 1;
+  return static_cast<int64_t>(4 + bucket % 4) << (exponent - 2);
+}
+
+}  // namespace
+
+// =============================================================================
+InstrumentedBarrier::InstrumentedBarrier(Barrier* barrier) : barrier_(barrier) {
+  Reset();
+  first_arrival_.store(std::numeric_limits<int64_t>::max());
+  last_arrival_.store(std::numeric_limits<int64_t>::min());
+}
+
+// =============================================================================
+InstrumentedBarrier::~InstrumentedBarrier() { delete barrier_; }
+
+// =============================================================================
+void InstrumentedBarrier::Wait(int num_threads, std::function<void()> policy) {
+  const int64_t arrival = RecordArrival(num_threads);
+  uint64_t num_spins = 0;
+  barrier_->Wait(num_threads, CountingPolicy{&policy, &num_spins});
+  RecordWait(arrival, num_spins);
+}
+
+// =============================================================================
+void InstrumentedBarrier::Wait(int num_threads, int thread_id,
+                               std::function<void()> policy) {
+  const int64_t arrival = RecordArrival(num_threads);
+  uint64_t num_spins = 0;
+  barrier_->Wait(num_threads, thread_id, CountingPolicy{&policy, &num_spins});
+  RecordWait(arrival, num_spins);
+}
+
+// =============================================================================
+Barrier::Token InstrumentedBarrier::Arrive(int num_threads) {
+  RecordArrival(num_threads);
+  return barrier_->Arrive(num_threads);
+}
+
+// =============================================================================
+void InstrumentedBarrier::Wait(Token token, std::function<void()> policy) {
+  const int64_t arrival = Now();
+  uint64_t num_spins = 0;
+  barrier_->Wait(token, CountingPolicy{&policy, &num_spins});
+  RecordWait(arrival, num_spins);
+}
+
+// =============================================================================
+void InstrumentedBarrier::SetCompletion(std::function<void()> completion) {
+  barrier_->SetCompletion(std::move(completion));
+}
+
+// =============================================================================
+void InstrumentedBarrier::SetEventCount(EventCount* event_count) {
+  barrier_->SetEventCount(event_count);
+}
+
+// =============================================================================
+BarrierStats InstrumentedBarrier::Snapshot() const {
+  BarrierStats stats;
+  stats.num_phases = skews_.count.load(std::memory_order_relaxed);
+  stats.skew = Summarize(skews_);
+  stats.wait = Summarize(waits_);
+  stats.num_spins = num_spins_.load(std::memory_order_relaxed);
+  stats.phase_skews_ns = phase_skews_;
+  for (int i = 0; i < kMaxThreadSlots; ++i) {
+    const LatenessSummary lateness = LatenessOf(thread_slots_[i]);
+    if (lateness.count == 0) continue;
+    stats.thread_lateness.resize(i + 1);
+    stats.thread_lateness[i] = lateness;
+  }
+  return stats;
+}
+
+// =============================================================================
+void InstrumentedBarrier::Reset() {
+  Clear(&skews_);
+  Clear(&waits_);
+  num_spins_.store(0, std::memory_order_relaxed);
+  phase_skews_.clear();
+  for (auto& slot : thread_slots_) {
+    slot.phase = 0;
+    slot.count = 0;
+    slot.sum_ns = 0;
+    slot.max_ns = 0;
+  }
+}
+
+// =============================================================================
+int64_t InstrumentedBarrier::RecordArrival(int num_threads) {
+  const int64_t arrival = Now();
+  const int slot_index = ThreadNumber();
+  if (slot_index < kMaxThreadSlots) {
+    // Account for my lateness in the previous phase, whose first arrival is
+    // known by now, and keep my arrival at this one.
+    ThreadSlot& slot = thread_slots_[slot_index];
+    if (slot.phase != 0 && slot.phase == num_completed_phases_) {
+      const int64_t lateness = slot.arrival - last_first_arrival_;
+      ++slot.count;
+      slot.sum_ns += lateness;
+      slot.max_ns = std::max(slot.max_ns, lateness);
+    }
+    slot.arrival = arrival;
+    slot.phase = num_completed_phases_ + 1;
+  }
+  int64_t first = first_arrival_.load(std::memory_order_relaxed);
+  while (arrival < first && !first_arrival_.compare_exchange_weak(
+                                first, arrival, std::memory_order_relaxed)) {
+  }
+  int64_t last = last_arrival_.load(std::memory_order_relaxed);
+  while (arrival > last && !last_arrival_.compare_exchange_weak(
+                               last, arrival, std::memory_order_relaxed)) {
+  }
+  if (phase_arrivals_.fetch_add(1, std::memory_order_acq_rel) >=
+      num_threads - 1) {
+    // Last thread arrives at the phase.
+    // Record its skew and reset the phase. The wrapped barrier publishes the
+    // reset to the threads arriving at the next phase.
+    first = first_arrival_.load(std::memory_order_relaxed);
+    const int64_t skew = last_arrival_.load(std::memory_order_relaxed) - first;
+    Record(&skews_, skew);
+    if (phase_skews_.size() < static_cast<size_t>(kMaxRecordedPhases))
+      phase_skews_.push_back(skew);
+    last_first_arrival_ = first;
+    ++num_completed_phases_;
+    first_arrival_.store(std::numeric_limits<int64_t>::max(),
+                         std::memory_order_relaxed);
+    last_arrival_.store(std::numeric_limits<int64_t>::min(),
+                        std::memory_order_relaxed);
+    phase_arrivals_.store(0, std::memory_order_relaxed);
+  }
+  return arrival;
+}
+
+// =============================================================================
+LatenessSummary InstrumentedBarrier::LatenessOf(const ThreadSlot& slot) const {
+  uint64_t count = slot.count;
+  int64_t sum_ns = slot.sum_ns;
+  LatenessSummary lateness;
+  lateness.max_ns = slot.max_ns;
+  if (slot.phase != 0 && slot.phase == num_completed_phases_) {
+    const int64_t last_lateness = slot.arrival - last_first_arrival_;
+    ++count;
+    sum_ns += last_lateness;
+    lateness.max_ns = std::max(lateness.max_ns, last_lateness);
+  }
+  lateness.count = count;
+  if (count > 0) lateness.mean_ns = sum_ns / static_cast<int64_t>(count);
+  return lateness;
+}
+
+// =============================================================================
+void InstrumentedBarrier::RecordWait(int64_t arrival, uint64_t num_spins) {
+  Record(&waits_, Now() - arrival);
+  num_spins_.fetch_add(num_spins, std::memory_order_relaxed);
+}
+
+// =============================================================================
+void InstrumentedBarrier::Record(Histogram* histogram, int64_t duration) {
+  histogram->buckets[BucketOf(duration)].fetch_add(1,
+                                                   std::memory_order_relaxed);
+  histogram->count.fetch_add(1, std::memory_order_relaxed);
+  histogram->sum.fetch_add(duration, std::memory_order_relaxed);
+  int64_t max = histogram->max.load(std::memory_order_relaxed);
+  while (duration > max && !histogram->max.compare_exchange_weak(
+                               max, duration, std::memory_order_relaxed)) {
+  }
+}
+
+// =============================================================================
+// Each percentile is estimated as the middle of the bucket it falls in, but
+// never above the exact maximum.
+DurationSummary InstrumentedBarrier::Summarize(const Histogram& histogram) {
+  DurationSummary summary;
+  summary.count = histogram.count.load(std::memory_order_relaxed);
+  if (summary.count == 0) return summary;
+  summary.mean_ns = histogram.sum.load(std::memory_order_relaxed) /
+                    static_cast<int64_t>(summary.count);
+  summary.max_ns = histogram.max.load(std::memory_order_relaxed);
+
+  const double quantiles[] = {0.50, 0.90, 0.99};
+  int64_t* percentiles[] = {&summary.p50_ns, &summary.p90_ns, &summary.p99_ns};
+  int next = 0;
+  uint64_t seen = 0;
+  for (int bucket = 0; bucket < kNumBuckets && next < 3; ++bucket) {
+    seen += histogram.buckets[bucket].load(std::memory_order_relaxed);
+    while (next < 3 && seen >= quantiles[next] * summary.count) {
+      const int64_t low = LowerBoundOf(bucket);
+      const int64_t middle = low + (LowerBoundOf(bucket + 1) - low) / 2;
+      *percentiles[next++] = middle < summary.max_ns ? middle : summary.max_ns;
+    }
+  }
+  return summary;
+}
+
+// =============================================================================
+void InstrumentedBarrier::Clear(Histogram* histogram) {
+  for (auto& bucket : histogram->buckets)
+    bucket.store(0, std::memory_order_relaxed);
+  histogram->count.store(0, std::memory_order_relaxed);
+  histogram->sum.store(0, std::memory_order_relaxed);
+  histogram->max.store(0, std::memory_order_relaxed);
+}
+
+// =============================================================================
+// Per-stage lines are averaged over all runs, and the phases of a run are
+// assumed to start at a multiple of `num_stages`.
+std::string ImbalanceReport(const std::string& title, const BarrierStats& stats,
+                            size_t num_stages) {
+  std::vector<double> skew_sums(num_stages, 0.0);
+  std::vector<int64_t> skew_maxs(num_stages, 0);
+  std::vector<size_t> num_runs(num_stages, 0);
+  for (size_t i = 0; i < stats.phase_skews_ns.size(); ++i) {
+    const size_t stage = i % num_stages;
+    skew_sums[stage] += stats.phase_skews_ns[i];
+    skew_maxs[stage] = std::max(skew_maxs[stage], stats.phase_skews_ns[i]);
+    ++num_runs[stage];
+  }
+  char line[128];
+  std::string report = title + "\n";
+  snprintf(line, sizeof(line), "  skew [us]: p50 %.1f | p99 %.1f | max %.1f\n",
+           stats.skew.p50_ns / 1e3, stats.skew.p99_ns / 1e3,
+           stats.skew.max_ns / 1e3);
+  report += line;
+  for (size_t stage = 0; stage < num_stages && num_runs[stage] > 0; ++stage) {
+    snprintf(line, sizeof(line),
+             "  stage %4zu: mean skew %10.1f [us] | max skew %10.1f [us]\n",
+             stage, skew_sums[stage] / num_runs[stage] / 1e3,
+             skew_maxs[stage] / 1e3);
+    report += line;
+  }
+  for (size_t thread = 0; thread < stats.thread_lateness.size(); ++thread) {
+    const LatenessSummary& lateness = stats.thread_lateness[thread];
+    if (lateness.count == 0) continue;
+    snprintf(line, sizeof(line),
+             "  thread %3zu: mean late %10.1f [us] | max late %10.1f [us]\n",
+             thread, lateness.mean_ns / 1e3, lateness.max_ns / 1e3);
+    report += line;
+  }
+  return report;
+}
+
+// =============================================================================
+std::map<std::string, std::string>& ImbalanceReports() {
+  static std::map<std::string, std::string>* reports =
+      new std::map<std::string, std::string>();
+  return *reports;
+}
+
+}  // namespace modcncy
@@ -0,0 +1,136 @@
+// Copyright 2022 The Modcncy Authors. All rights reserved.
+// Use of this source code is governed by the license found in the LICENSE file.
+// -----------------------------------------------------------------------------
+
+#include "modcncy/src/primitives/barriers/numa_hierarchical_barrier.h"
+
+#include <sched.h>
+
+#include <utility>
+
+#include "modcncy/src/topology/cpu_topology.h"
+
+namespace modcncy {
+namespace primitives {
+namespace {
+
+// Bit of the state of a node telling that it has a delegate.
+constexpr uint64_t kDelegate = uint64_t{1} << 31;
+
+// Bits of the state of a node counting its arrivals.
+constexpr uint64_t kArrivals = kDelegate - 1;
+
+}  // namespace
+
+// =============================================================================
+NumaHierarchicalBarrier::NumaHierarchicalBarrier() {
+  const topology::NumaTopology numa = topology::ReadNumaTopology();
+  node_of_cpu_ = numa.node_of_cpu;
+  num_nodes_ = static_cast<int>(numa.cpus_of_node.size());
+  nodes_.Get(num_nodes_);
+}
+
+// =============================================================================
+int NumaHierarchicalBarrier::CurrentNode() const {
+  const int cpu = sched_getcpu();
+  return cpu >= 0 && cpu < static_cast<int>(node_of_cpu_.size())
+             ? node_of_cpu_[cpu]
+             : 0;
+}
+
+// =============================================================================
+bool NumaHierarchicalBarrier::AddArrivals(int arrivals, unsigned step) {
+  if (global_arrivals_.fetch_add(arrivals, std::memory_order_acq_rel) +
+          arrivals !=
+      num_threads_.load(std::memory_order_relaxed))
+    return false;
+  // Last thread enters the barrier.
+  // Run the completion function, reset the global counter and increase the
+  // step.
+  Complete();
+  global_arrivals_.store(0, std::memory_order_relaxed);
+  step_.store(step + 1, std::memory_order_release);
+  Notify();
+  return true;
+}
+
+// =============================================================================
+void NumaHierarchicalBarrier::Wait(int num_threads,
+                                   std::function<void()> policy) {
+  Wait(Arrive(num_threads), std::move(policy));
+}
+
+// =============================================================================
+// The token tells the node of the thread (upper bits) and whether it is its
+// delegate (lowest bit).
+Barrier::Token NumaHierarchicalBarrier::Arrive(int num_threads) {
+  const unsigned current_step = step_.load(std::memory_order_relaxed);
+  const uint64_t tag = static_cast<uint64_t>(current_step) << 32 | kDelegate;
+  const int node_index = CurrentNode();
+  Node& node = nodes_.Get(num_nodes_)[node_index];
+
+  // Arrive at my node. A node tagged with a previous step has no delegate yet.
+  uint64_t state = node.state.load(std::memory_order_relaxed);
+  bool is_delegate;
+  do {
+    is_delegate = (state >> 32) != current_step || (state & kDelegate) == 0;
+  } while (!node.state.compare_exchange_weak(
+      state, is_delegate ? tag : state + 1, std::memory_order_acq_rel,
+      std::memory_order_relaxed));
+
+  const unsigned role = static_cast<unsigned>(node_index) << 1;
+  if (!is_delegate) {
+    // Let a parked delegate take my arrival.
+    Notify();
+    return Token{current_step, role};
+  }
+
+  // Delegate. Add my own arrival to the global counter. No thread completes
+  // the count before all delegates have stored the number of threads.
+  if (num_threads_.load(std::memory_order_relaxed) != num_threads)
+    num_threads_.store(num_threads, std::memory_order_relaxed);
+  AddArrivals(/*arrivals=*/1, current_step);
+  return Token{current_step, role | 1};
+}
+
+// =============================================================================
+void NumaHierarchicalBarrier::Wait(Token token, std::function<void()> policy) {
+  const unsigned current_step = token.phase;
+  Node& node = nodes_.Get(num_nodes_)[token.role >> 1];
+
+  if ((token.role & 1) == 0) {
+    // Wait until the delegate of my node releases me. The release flag counts
+    // the released steps, so a late release of the previous step is ignored.
+    WatchAddress(&policy, &node.released_step);
+    while (static_cast<int>(node.released_step.load(std::memory_order_acquire) -
+                            (current_step + 1)) < 0)
+      policy();
+    return;
+  }
+
+  // Delegate. Move the arrivals at my node to the global counter until the
+  // last thread arrives.
+  const uint64_t tag = static_cast<uint64_t>(current_step) << 32 | kDelegate;
+  WatchAddress(&policy, &step_);
+  for (;;) {
+    // Take the arrivals at my node during the current step, if any.
+    uint64_t state = node.state.load(std::memory_order_relaxed);
+    while ((state >> 32) == current_step && (state & kArrivals) != 0) {
+      if (node.state.compare_exchange_weak(state, tag,
+                                           std::memory_order_acq_rel,
+                                           std::memory_order_relaxed)) {
+        AddArrivals(static_cast<int>(state & kArrivals), current_step);
+        break;
+      }
+    }
+    if (step_.load(std::memory_order_acquire) != current_step) break;
+    policy();
+  }
+
+  // Release the threads of my node.
+  node.released_step.store(current_step + 1, std::memory_order_release);
+  Notify();
+}
+
+}  // namespace primitives
+}  // namespace modcncy
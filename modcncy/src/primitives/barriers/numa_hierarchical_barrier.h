@@ -0,0 +1,114 @@
+// Copyright 2022 The Modcncy Authors. All rights reserved.
+// Use of this source code is governed by the license found in the LICENSE file.
+// -----------------------------------------------------------------------------
+//
+// The `NumaHierarchicalBarrier` is a two-level barrier for hosts with several
+// NUMA nodes (sockets), where threads first synchronize with the threads of
+// their own node and only one thread per node touches the global level. Its
+// behavior is summarized as follows:
+//
+//   1. When a thread arrives at the barrier, it looks up the NUMA node of the
+//      CPU it is running on. The first thread to arrive at a node becomes its
+//      delegate. Any other thread increases the counter of its node and spins
+//      on the release flag of its node.
+//
+//   2. While waiting, the delegate of each node moves the arrivals counted at
+//      its node to the global counter. This way, only the delegates touch the
+//      global level, and threads arriving together are added in a single batch.
+//
+//   3. When the global counter reaches the number of threads, the delegate that
+//      made it reach it runs the completion function, if any, resets the global
+//      counter and increases the global step. Each delegate, spinning on the
+//      global step, then releases the threads of its node by updating its
+//      release flag.
+//
+// With the split-phase interface, `Arrive()` covers the arrival at the node
+// and, for a delegate, the addition of its own arrival to the global counter.
+// The arrivals that other threads make at its node reach the global level once
+// the delegate waits on its token.
+//
+// Node counters are tagged with the step they belong to, so they never need to
+// be reset, and node membership is decided on every arrival, so threads are
+// free to migrate and the barrier is reusable with a different number of
+// threads.
+//
+// -----------------------------------------------------------------------------
+
+#ifndef MODCNCY_SRC_PRIMITIVES_BARRIERS_NUMA_HIERARCHICAL_BARRIER_H_
+#define MODCNCY_SRC_PRIMITIVES_BARRIERS_NUMA_HIERARCHICAL_BARRIER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "modcncy/include/modcncy/barrier.h"
+#include "modcncy/include/modcncy/global_expressions.h"
+#include "modcncy/src/primitives/barriers/growing_array.h"
+
+namespace modcncy {
+namespace primitives {
+
+class NumaHierarchicalBarrier : public Barrier {
+ public:
+  NumaHierarchicalBarrier();
+
+  using Barrier::Wait;
+
+  // A thread must wait here until all threads reach this point.
+  void Wait(int num_threads, std::function<void()> policy) override;
+
+  // A thread signals its arrival without waiting for all other threads.
+  Token Arrive(int num_threads) override;
+
+  // A thread must wait here until all threads arrive at the `token` phase.
+  void Wait(Token token, std::function<void()> policy) override;
+
+ private:
+  // Per-node state.
+  struct alignas(kCacheLineSize) Node {
+    // Step (upper 32 bits), whether the node has a delegate for that step
+    // (bit 31) and number of arrivals at this node during that step not yet
+    // added to the global counter (lower 31 bits).
+    std::atomic<uint64_t> state;
+    // Number of barrier synchronizations released so far at this node.
+    std::atomic<unsigned> released_step;
+  };  // struct Node
+
+  // Returns the NUMA node of the calling thread.
+  int CurrentNode() const;
+
+  // Adds `arrivals` made during `step` to the global counter. The delegate
+  // completing the count releases the barrier and returns `true`.
+  bool AddArrivals(int arrivals, unsigned step);
+
+  // NUMA node of each CPU.
+  std::vector<int> node_of_cpu_;
+
+  // Number of NUMA nodes.
+  int num_nodes_;
+
+  // Per-node states.
+  GrowingArray<Node> nodes_;
+
+  // Padding to prevent false sharing.
+  char padding_[kCacheLineSize];
+
+  // Number of threads whose arrival reached the global level.
+  std::atomic<int> global_arrivals_{0};
+
+  // Number of threads taking part in the current step, as last given to
+  // `Arrive()` by a delegate.
+  std::atomic<int> num_threads_{0};
+
+  // Padding to prevent false sharing.
+  char padding2_[kCacheLineSize - 2 * sizeof(std::atomic<int>)];
+
+  // Number of barrier synchronizations completed so far.
+  // The barrier is reusable since unsigned data type wraps around the overflow.
+  std::atomic<unsigned> step_{0};
+};  // class NumaHierarchicalBarrier
+
+}  // namespace primitives
+}  // namespace modcncy
+
+#endif  // MODCNCY_SRC_PRIMITIVES_BARRIERS_NUMA_HIERARCHICAL_BARRIER_H_
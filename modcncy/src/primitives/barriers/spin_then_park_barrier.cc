@@ -0,0 +1,59 @@
+// Copyright 2022 The Modcncy Authors. All rights reserved.
+// Use of this source code is governed by the license found in the LICENSE file.
+// -----------------------------------------------------------------------------
+
+#include "modcncy/src/primitives/barriers/spin_then_park_barrier.h"
+
+#include "modcncy/src/primitives/futex.h"
+
+namespace modcncy {
+namespace primitives {
+
+// =============================================================================
+SpinThenParkBarrier::SpinThenParkBarrier(int spin_budget)
+    : spin_budget_(spin_budget) {}
+
+// =============================================================================
+void SpinThenParkBarrier::Wait(int num_threads, std::function<void()> policy) {
+  const Token token = SpinThenParkBarrier::Arrive(num_threads);
+  SpinThenParkBarrier::Wait(token, policy);
+}
+
+// =============================================================================
+Barrier::Token SpinThenParkBarrier::Arrive(int num_threads) {
+  const int current_step = step_.load(std::memory_order_relaxed);
+  if (spinning_threads_.fetch_add(1, std::memory_order_acq_rel) >=
+      num_threads - 1) {
+    // Last thread enters the barrier.
+    // Run the completion function, reset number of spinning threads, increase
+    // the step and wake up parked threads, if any.
+    Complete();
+    spinning_threads_.store(0, std::memory_order_relaxed);
+    step_.fetch_add(1, std::memory_order_seq_cst);
+    if (parked_threads_.load(std::memory_order_seq_cst) > 0)
+      FutexWakeAll(&step_);
+    Notify();
+  }
+  return Token{static_cast<unsigned>(current_step), 0};
+}
+
+// =============================================================================
+void SpinThenParkBarrier::Wait(Token token, std::function<void()> policy) {
+  const int current_step = static_cast<int>(token.phase);
+  // Spin for a while, hoping that the last thread arrives soon.
+  WatchAddress(&policy, &step_);
+  for (int i = 0; i < spin_budget_; ++i) {
+    if (step_.load(std::memory_order_acquire) != current_step) return;
+    policy();
+  }
+  // Park until last thread arrives.
+  // Announcing the parked thread before checking the step pairs with the
+  // last thread increasing the step before checking for parked threads.
+  parked_threads_.fetch_add(1, std::memory_order_seq_cst);
+  while (step_.load(std::memory_order_seq_cst) == current_step)
+    FutexWait(&step_, current_step);
+  parked_threads_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+}  // namespace primitives
+}  // namespace modcncy
@@ -0,0 +1,81 @@
+// Copyright 2022 The Modcncy Authors. All rights reserved.
+// Use of this source code is governed by the license found in the LICENSE file.
+// -----------------------------------------------------------------------------
+//
+// The `SpinThenParkBarrier` is a central step counter barrier for hosts where
+// threads may outnumber the available cores. Instead of spinning for as long as
+// it takes, a waiting thread gives up the processor and sleeps on a Linux futex
+// after a bounded spin. Its behavior is summarized as follows:
+//
+//   1. When a thread arrives at the barrier, it increases the shared counter
+//      and spins on the current step for at most `spin_budget` iterations of
+//      the applied wait policy.
+//
+//   2. If the step did not change in the meantime, the thread parks on the
+//      futex keyed on the step word until it is woken up.
+//
+//   3. When the last thread arrives at the barrier, it runs the completion
+//      function, if any, resets the shared counter, increases the current step
+//      and, only if some thread is parked, wakes all of them with a single
+//      `FUTEX_WAKE`.
+//
+// With the split-phase interface, `Arrive()` covers the shared counter and the
+// wake-up, and `Wait()` the spinning and parking on the returned step.
+//
+// -----------------------------------------------------------------------------
+
+#ifndef MODCNCY_SRC_PRIMITIVES_BARRIERS_SPIN_THEN_PARK_BARRIER_H_
+#define MODCNCY_SRC_PRIMITIVES_BARRIERS_SPIN_THEN_PARK_BARRIER_H_
+
+#include <atomic>
+
+#include "modcncy/include/modcncy/barrier.h"
+#include "modcncy/include/modcncy/global_expressions.h"
+
+namespace modcncy {
+namespace primitives {
+
+class SpinThenParkBarrier : public Barrier {
+ public:
+  // Default number of spin iterations before parking.
+  static constexpr int kDefaultSpinBudget = 256;
+
+  explicit SpinThenParkBarrier(int spin_budget = kDefaultSpinBudget);
+
+  using Barrier::Wait;
+
+  // A thread must wait here until all threads reach this point.
+  void Wait(int num_threads, std::function<void()> policy) override;
+
+  // A thread signals its arrival without waiting for all other threads.
+  Token Arrive(int num_threads) override;
+
+  // A thread must wait here until all threads arrive at the `token` phase.
+  void Wait(Token token, std::function<void()> policy) override;
+
+ private:
+  // Number of spin iterations before parking.
+  const int spin_budget_;
+
+  // Padding to prevent false sharing.
+  char padding_[kCacheLineSize - sizeof(int)];
+
+  // Number of threads spinning at the barrier.
+  std::atomic<int> spinning_threads_{0};
+
+  // Padding to prevent false sharing.
+  char padding2_[kCacheLineSize - sizeof(std::atomic<int>)];
+
+  // Number of barrier synchronizations completed so far.
+  // The barrier is reusable since the step wraps around the overflow.
+  // Its address is the futex word parked threads sleep on.
+  std::atomic<int> step_{0};
+
+  // Number of threads parked (or about to park) on the futex.
+  std::atomic<int> parked_threads_{0};
+};  // class SpinThenParkBarrier
+
+}  // namespace primitives
+}  // namespace modcncy
+
+#endif  // MODCNCY_SRC_PRIMITIVES_BARRIERS_SPIN_THEN_PARK_BARRIER_H_
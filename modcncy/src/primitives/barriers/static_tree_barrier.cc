@@ -0,0 +1,60 @@
+// Copyright 2022 The Modcncy Authors. All rights reserved.
+// Use of this source code is governed by the license found in the LICENSE file.
+// -----------------------------------------------------------------------------
+
+#include "modcncy/src/primitives/barriers/static_tree_barrier.h"
+
+namespace modcncy {
+namespace primitives {
+
+// =============================================================================
+void StaticTreeBarrier::Wait(int num_threads, std::function<void()> policy) {
+  Wait(num_threads, /*thread_id=*/tickets_.Next(num_threads), policy);
+}
+
+// =============================================================================
+void StaticTreeBarrier::Wait(int num_threads, int thread_id,
+                             std::function<void()> policy) {
+  Node* nodes = nodes_.Get(num_threads);
+  Node& my_node = nodes[thread_id];
+  const bool is_root = thread_id == 0;
+
+  // Account for the awaited signals before signaling anyone. Thus, the next
+  // holder of this thread identity is guaranteed to observe them.
+  int num_children = 0;
+  for (int i = 1; i <= kArrivalFanIn; ++i)
+    if (kArrivalFanIn * thread_id + i < num_threads) ++num_children;
+  my_node.awaited_arrivals += num_children;
+  const unsigned awaited_arrivals = my_node.awaited_arrivals;
+  const unsigned awaited_wakeups = is_root ? 0 : ++my_node.awaited_wakeups;
+
+  // Arrival. Wait for my children and then signal my parent.
+  WatchAddress(&policy, &my_node.arrivals);
+  while (static_cast<int>(my_node.arrivals.load(std::memory_order_acquire) -
+                          awaited_arrivals) < 0)
+    policy();
+  if (!is_root) {
+    const int parent = (thread_id - 1) / kArrivalFanIn;
+    nodes[parent].arrivals.fetch_add(1, std::memory_order_release);
+    Notify();
+    WatchAddress(&policy, &my_node.wakeups);
+    while (static_cast<int>(my_node.wakeups.load(std::memory_order_acquire) -
+                            awaited_wakeups) < 0)
+      policy();
+  } else {
+    // The root knows that all threads have arrived.
+    Complete();
+  }
+
+  // Wake-up. Release my children in the wake-up tree.
+  for (int i = 1; i <= kWakeupFanOut; ++i) {
+    const int child = kWakeupFanOut * thread_id + i;
+    if (child < num_threads) {
+      nodes[child].wakeups.fetch_add(1, std::memory_order_release);
+      Notify();
+    }
+  }
+}
+
+}  // namespace primitives
+}  // namespace modcncy
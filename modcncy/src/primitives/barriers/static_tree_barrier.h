@@ -0,0 +1,78 @@
+// Copyright 2022 The Modcncy Authors. All rights reserved.
+// Use of this source code is governed by the license found in the LICENSE file.
+// -----------------------------------------------------------------------------
+//
+// The `StaticTreeBarrier` is the tree barrier of Mellor-Crummey and Scott, where
+// each thread owns a node of a 4-ary arrival tree and of a binary wake-up tree,
+// and every thread spins only on its own node. Its behavior is summarized as
+// follows:
+//
+//   1. When a thread arrives at the barrier, it waits until the (up to four)
+//      children of its node in the arrival tree have arrived, signals its
+//      parent, and starts spinning on its own wake-up flag.
+//
+//   2. When the root thread (identity 0) has heard from all its children, all
+//      threads have arrived. It wakes up its (up to two) children in the
+//      wake-up tree, which in turn wake up their children, and so on and so
+//      forth.
+//
+// Flags are counters of the received signals, so they never need to be reset
+// and the barrier is reusable with a different number of threads.
+//
+// Threads that do not provide their identity take one from a central ticket,
+// which brings back a shared counter on the way in.
+//
+// -----------------------------------------------------------------------------
+
+#ifndef MODCNCY_SRC_PRIMITIVES_BARRIERS_STATIC_TREE_BARRIER_H_
+#define MODCNCY_SRC_PRIMITIVES_BARRIERS_STATIC_TREE_BARRIER_H_
+
+#include <atomic>
+
+#include "modcncy/include/modcncy/barrier.h"
+#include "modcncy/include/modcncy/global_expressions.h"
+#include "modcncy/src/primitives/barriers/arrival_tickets.h"
+#include "modcncy/src/primitives/barriers/growing_array.h"
+
+namespace modcncy {
+namespace primitives {
+
+class StaticTreeBarrier : public Barrier {
+ public:
+  // A thread must wait here until all threads reach this point.
+  void Wait(int num_threads, std::function<void()> policy) override;
+
+  // A thread must wait here until all threads reach this point.
+  void Wait(int num_threads, int thread_id,
+            std::function<void()> policy) override;
+
+ private:
+  // Number of children of a node in the arrival tree.
+  static constexpr int kArrivalFanIn = 4;
+
+  // Number of children of a node in the wake-up tree.
+  static constexpr int kWakeupFanOut = 2;
+
+  // Per-thread node.
+  struct alignas(kCacheLineSize) Node {
+    // Number of signals received from the children in the arrival tree.
+    std::atomic<unsigned> arrivals;
+    // Number of signals received from the parent in the wake-up tree.
+    std::atomic<unsigned> wakeups;
+    // Number of signals awaited so far. Owned by the current holder of the
+    // thread identity, and only updated before signaling any other node.
+    unsigned awaited_arrivals;
+    unsigned awaited_wakeups;
+  };  // struct Node
+
+  // Identities for the threads that do not provide one.
+  ArrivalTickets tickets_;
+
+  // Nodes of each thread identity.
+  GrowingArray<Node> nodes_;
+};  // class StaticTreeBarrier
+
+}  // namespace primitives
+}  // namespace modcncy
+
+#endif  // MODCNCY_SRC_PRIMITIVES_BARRIERS_STATIC_TREE_BARRIER_H_
@@ -0,0 +1,73 @@
+// Copyright 2022 The Modcncy Authors. All rights reserved.
+// Use of this source code is governed by the license found in the LICENSE file.
+// -----------------------------------------------------------------------------
+
+#include "modcncy/src/primitives/barriers/tournament_barrier.h"
+
+namespace modcncy {
+namespace primitives {
+
+// =============================================================================
+void TournamentBarrier::Wait(int num_threads, std::function<void()> policy) {
+  Wait(num_threads, /*thread_id=*/tickets_.Next(num_threads), policy);
+}
+
+// =============================================================================
+void TournamentBarrier::Wait(int num_threads, int thread_id,
+                             std::function<void()> policy) {
+  Flags* flags = flags_.Get(num_threads);
+  Flags& my_flags = flags[thread_id];
+
+  // The thread loses in the round of its lowest set bit. The champion never
+  // loses, but it plays all the rounds.
+  int lost_round = 0;
+  while (lost_round < kMaxRounds - 1 && (1 << lost_round) < num_threads &&
+         (thread_id & (1 << lost_round)) == 0)
+    ++lost_round;
+  const bool is_champion = thread_id == 0;
+
+  // Account for the awaited signals before signaling anyone. Thus, the next
+  // holder of this thread identity is guaranteed to observe them.
+  unsigned awaited_arrivals[kMaxRounds];
+  for (int round = 0; round < lost_round; ++round) {
+    if (thread_id + (1 << round) < num_threads)
+      awaited_arrivals[round] = ++my_flags.awaited_arrivals[round];
+  }
+  const unsigned awaited_wakeups =
+      is_champion ? 0 : ++my_flags.awaited_wakeups;
+
+  // Arrival. Win every round until losing one, waiting for each opponent.
+  for (int round = 0; round < lost_round; ++round) {
+    if (thread_id + (1 << round) >= num_threads) continue;  // Bye.
+    WatchAddress(&policy, &my_flags.arrivals[round]);
+    while (static_cast<int>(
+               my_flags.arrivals[round].load(std::memory_order_acquire) -
+               awaited_arrivals[round]) < 0)
+      policy();
+  }
+  if (!is_champion) {
+    // Signal the winner and wait until it wakes me up.
+    const int winner = thread_id - (1 << lost_round);
+    flags[winner].arrivals[lost_round].fetch_add(1, std::memory_order_release);
+    Notify();
+    WatchAddress(&policy, &my_flags.wakeups);
+    while (static_cast<int>(my_flags.wakeups.load(std::memory_order_acquire) -
+                            awaited_wakeups) < 0)
+      policy();
+  } else {
+    // The champion knows that all threads have arrived.
+    Complete();
+  }
+
+  // Wake-up. Release every opponent defeated on the way, latest first.
+  for (int round = lost_round - 1; round >= 0; --round) {
+    const int loser = thread_id + (1 << round);
+    if (loser < num_threads) {
+      flags[loser].wakeups.fetch_add(1, std::memory_order_release);
+      Notify();
+    }
+  }
+}
+
+}  // namespace primitives
+}  // namespace modcncy
@@ -0,0 +1,75 @@
+// Copyright 2022 The Modcncy Authors. All rights reserved.
+// Use of this source code is governed by the license found in the LICENSE file.
+// -----------------------------------------------------------------------------
+//
+// The `TournamentBarrier` is the tournament barrier of Mellor-Crummey and Scott,
+// where threads play ceil(log2(num_threads)) rounds of statically determined
+// matches and every thread spins only on its own flags. Its behavior is
+// summarized as follows:
+//
+//   1. In round `r`, the thread with identity `i + 2^r` loses against the
+//      thread with identity `i`, for every `i` multiple of `2^(r+1)`. The loser
+//      signals the winner and starts spinning on its own wake-up flag. The
+//      winner waits for the signal and plays the next round.
+//
+//   2. When the champion (identity 0) wins its last round, all threads have
+//      arrived. It wakes up every thread it defeated, which in turn wake up the
+//      threads they defeated, and so on and so forth.
+//
+// Flags are counters of the received signals, so they never need to be reset
+// and the barrier is reusable with a different number of threads.
+//
+// Threads that do not provide their identity take one from a central ticket,
+// which brings back a shared counter on the way in.
+//
+// -----------------------------------------------------------------------------
+
+#ifndef MODCNCY_SRC_PRIMITIVES_BARRIERS_TOURNAMENT_BARRIER_H_
+#define MODCNCY_SRC_PRIMITIVES_BARRIERS_TOURNAMENT_BARRIER_H_
+
+#include <atomic>
+
+#include "modcncy/include/modcncy/barrier.h"
+#include "modcncy/include/modcncy/global_expressions.h"
+#include "modcncy/src/primitives/barriers/arrival_tickets.h"
+#include "modcncy/src/primitives/barriers/growing_array.h"
+
+namespace modcncy {
+namespace primitives {
+
+class TournamentBarrier : public Barrier {
+ public:
+  // A thread must wait here until all threads reach this point.
+  void Wait(int num_threads, std::function<void()> policy) override;
+
+  // A thread must wait here until all threads reach this point.
+  void Wait(int num_threads, int thread_id,
+            std::function<void()> policy) override;
+
+ private:
+  // Enough rounds for any positive `int` number of threads.
+  static constexpr int kMaxRounds = 32;
+
+  // Per-thread flags.
+  struct alignas(kCacheLineSize) Flags {
+    // Number of signals received from the loser of each round.
+    std::atomic<unsigned> arrivals[kMaxRounds];
+    // Number of signals received from the winner of the lost round.
+    std::atomic<unsigned> wakeups;
+    // Number of signals awaited so far. Owned by the current holder of the
+    // thread identity, and only updated before signaling any opponent.
+    unsigned awaited_arrivals[kMaxRounds];
+    unsigned awaited_wakeups;
+  };  // struct Flags
+
+  // Identities for the threads that do not provide one.
+  ArrivalTickets tickets_;
+
+  // Flags of each thread identity.
+  GrowingArray<Flags> flags_;
+};  // class TournamentBarrier
+
+}  // namespace primitives
+}  // namespace modcncy
+
+#endif  // MODCNCY_SRC_PRIMITIVES_BARRIERS_TOURNAMENT_BARRIER_H_
@@ -0,0 +1,27 @@
+// Copyright 2022 The Modcncy Authors. All rights reserved.
+// Use of this source code is governed by the license found in the LICENSE file.
+// -----------------------------------------------------------------------------
+
+#include "modcncy/include/modcncy/wait_policy.h"
+#include "modcncy/src/primitives/futex.h"
+
+namespace modcncy {
+
+// =============================================================================
+// Announcing the parked thread before checking the epoch pairs with the
+// notifying thread increasing the epoch before checking for parked threads.
+void EventCount::Wait(unsigned epoch) {
+  num_waiters_.fetch_add(1, std::memory_order_seq_cst);
+  while (epoch_.load(std::memory_order_seq_cst) == static_cast<int>(epoch))
+    primitives::FutexWait(&epoch_, static_cast<int>(epoch));
+  num_waiters_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+// =============================================================================
+void EventCount::NotifyAll() {
+  epoch_.fetch_add(1, std::memory_order_seq_cst);
+  if (num_waiters_.load(std::memory_order_seq_cst) > 0)
+    primitives::FutexWakeAll(&epoch_);
+}
+
+}  // namespace modcncy
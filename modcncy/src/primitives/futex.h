@@ -0,0 +1,40 @@
+// Copyright 2022 The Modcncy Authors. All rights reserved.
+// Use of this source code is governed by the license found in the LICENSE file.
+// -----------------------------------------------------------------------------
+//
+// Thin wrappers of the Linux futex system call, for the primitives that park
+// threads instead of spinning.
+//
+// -----------------------------------------------------------------------------
+
+#ifndef MODCNCY_SRC_PRIMITIVES_FUTEX_H_
+#define MODCNCY_SRC_PRIMITIVES_FUTEX_H_
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <climits>
+
+namespace modcncy {
+namespace primitives {
+
+// =============================================================================
+// Sleeps on `word` as long as it holds `value`.
+inline void FutexWait(std::atomic<int>* word, int value) {
+  syscall(SYS_futex, reinterpret_cast<int*>(word), FUTEX_WAIT_PRIVATE, value,
+          nullptr, nullptr, 0);
+}
+
+// =============================================================================
+// Wakes all threads sleeping on `word`.
+inline void FutexWakeAll(std::atomic<int>* word) {
+  syscall(SYS_futex, reinterpret_cast<int*>(word), FUTEX_WAKE_PRIVATE, INT_MAX,
+          nullptr, nullptr, 0);
+}
+
+}  // namespace primitives
+}  // namespace modcncy
+
+#endif  // MODCNCY_SRC_PRIMITIVES_FUTEX_H_
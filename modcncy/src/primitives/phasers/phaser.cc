@@ -0,0 +1,86 @@
+// Copyright 2022 The Modcncy Authors. All rights reserved.
+// Use of this source code is governed by the license found in the LICENSE file.
+// -----------------------------------------------------------------------------
+
+#include "modcncy/include/modcncy/phaser.h"
+
+#include <cassert>
+
+namespace modcncy {
+namespace {
+
+// =============================================================================
+// Packs the fields of the state of a phaser into a single word. The number of
+// participants must fit its field.
+uint64_t Pack(unsigned phase, unsigned participants, unsigned unarrived) {
+  assert(participants <= static_cast<unsigned>(Phaser::kMaxParticipants));
+  assert(unarrived <= participants);
+  return static_cast<uint64_t>(phase) << 32 |
+         static_cast<uint64_t>(participants & 0xFFFF) << 16 |
+         (unarrived & 0xFFFF);
+}
+
+// =============================================================================
+// Fields of the state of a phaser.
+unsigned Phase(uint64_t state) { return state >> 32; }
+unsigned Participants(uint64_t state) { return (state >> 16) & 0xFFFF; }
+unsigned Unarrived(uint64_t state) { return state & 0xFFFF; }
+
+}  // namespace
+
+// =============================================================================
+Phaser::Phaser(int num_participants)
+    : state_(Pack(/*phase=*/0, num_participants, num_participants)) {}
+
+// =============================================================================
+unsigned Phaser::Register() {
+  uint64_t state = state_.load(std::memory_order_relaxed);
+  while (!state_.compare_exchange_weak(
+      state,
+      Pack(Phase(state), Participants(state) + 1, Unarrived(state) + 1),
+      std::memory_order_acq_rel, std::memory_order_relaxed)) {
+  }
+  return Phase(state);
+}
+
+// =============================================================================
+unsigned Phaser::Wait(std::function<void()> policy) {
+  const uint64_t state = Arrive(/*deregister=*/false);
+  const unsigned phase = Phase(state);
+  if (Unarrived(state) > 1) {
+    // Wait until last participant arrives. The watched low word of the state
+    // changes on every arrival, and so on every phase.
+    WatchAddress(&policy, &state_);
+    while (Phase(state_.load(std::memory_order_acquire)) == phase) policy();
+  }
+  return phase;
+}
+
+// =============================================================================
+unsigned Phaser::ArriveAndDeregister() {
+  return Phase(Arrive(/*deregister=*/true));
+}
+
+// =============================================================================
+uint64_t Phaser::Arrive(bool deregister) {
+  uint64_t state = state_.load(std::memory_order_relaxed);
+  uint64_t next_state;
+  do {
+    // Only registered participants arrive.
+    assert(Participants(state) > 0);
+    const unsigned participants = Participants(state) - (deregister ? 1 : 0);
+    if (Unarrived(state) > 1) {
+      // Count current participant as arrived.
+      next_state = Pack(Phase(state), participants, Unarrived(state) - 1);
+    } else {
+      // Last participant enters the phaser.
+      // Advance to the next phase, which awaits all remaining participants.
+      next_state = Pack(Phase(state) + 1, participants, participants);
+    }
+  } while (!state_.compare_exchange_weak(state, next_state,
+                                         std::memory_order_acq_rel,
+                                         std::memory_order_relaxed));
+  return state;
+}
+
+}  // namespace modcncy
@@ -0,0 +1,67 @@
+// Copyright 2022 The Modcncy Authors. All rights reserved.
+// Use of this source code is governed by the license found in the LICENSE file.
+// -----------------------------------------------------------------------------
+
+#include <chrono>  // NOLINT(build/c++11)
+#include <cstdint>
+
+#include "modcncy/include/modcncy/wait_policy.h"
+
+namespace modcncy {
+namespace {
+
+// =============================================================================
+// Returns the current time of the steady clock, in nanoseconds.
+int64_t Now() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+}  // namespace
+
+// Constants odr-used by callers need a definition before C++17.
+constexpr int64_t WaitEstimate::kSampleWeight;
+constexpr int64_t AdaptiveWaitPolicy::kMinSpinNs;
+constexpr int64_t AdaptiveWaitPolicy::kDefaultMaxSpinNs;
+
+// =============================================================================
+AdaptiveWaitPolicy::~AdaptiveWaitPolicy() {
+  if (is_waiting_) estimate_->Record(Now() - start_ns_);
+}
+
+void AdaptiveWaitPolicy::Reset() {
+  if (is_waiting_) estimate_->Record(Now() - start_ns_);
+  is_waiting_ = false;
+  epoch_ = 0;
+}
+
+// =============================================================================
+void AdaptiveWaitPolicy::operator()() {
+  const int64_t now_ns = Now();
+  // Parking needs the epoch read before the caller last checked the
+  // condition, which only a previous iteration could have read.
+  const bool can_park = event_count_ != nullptr && is_waiting_;
+  if (!is_waiting_) {
+    is_waiting_ = true;
+    start_ns_ = now_ns;
+    spin_ns_ = SpinNs();
+  }
+  if (now_ns - start_ns_ < spin_ns_)
+    cpu_pause();
+  else if (can_park)
+    event_count_->Wait(epoch_);
+  else
+    cpu_yield();
+  if (event_count_ != nullptr) epoch_ = event_count_->Epoch();
+}
+
+// =============================================================================
+int64_t AdaptiveWaitPolicy::SpinNs() const {
+  const int64_t expected_ns = estimate_->ExpectedNs();
+  if (expected_ns > max_spin_ns_) return kMinSpinNs;
+  const int64_t spin_ns = 2 * expected_ns + kMinSpinNs;
+  return spin_ns < max_spin_ns_ ? spin_ns : max_spin_ns_;
+}
+
+}  // namespace modcncy
@@ -0,0 +1,80 @@
+// Copyright 2022 The Modcncy Authors. All rights reserved.
+// Use of this source code is governed by the license found in the LICENSE file.
+// -----------------------------------------------------------------------------
+
+#include <cpuid.h>
+#include <immintrin.h>
+#include <x86intrin.h>
+
+#include "modcncy/include/modcncy/wait_policy.h"
+
+namespace modcncy {
+namespace {
+
+// CPUID.(EAX=07H, ECX=0H):ECX bit flagging the WAITPKG instructions.
+constexpr unsigned kWaitPkgBit = 1u << 5;
+
+// Control bit of `UMWAIT` and `TPAUSE` requesting the C0.1 state, which is
+// lighter than C0.2 and wakes up faster.
+constexpr unsigned kC01State = 1;
+
+// =============================================================================
+bool DetectWaitPkg() {
+  unsigned eax, ebx, ecx, edx;
+  if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) return false;
+  return (ecx & kWaitPkgBit) != 0;
+}
+
+// =============================================================================
+// Reads the watched word.
+unsigned Load(const void* address) {
+  return __atomic_load_n(static_cast<const unsigned*>(address),
+                         __ATOMIC_RELAXED);
+}
+
+// =============================================================================
+// Arms the monitor on `address`. Only called when WAITPKG is supported.
+__attribute__((target("waitpkg"))) void Monitor(const void* address) {
+  _umonitor(const_cast<void*>(address));
+}
+
+// =============================================================================
+// Sleeps until the monitored line is written or `deadline` is reached.
+__attribute__((target("waitpkg"))) void MonitoredSleep(uint64_t deadline) {
+  _umwait(kC01State, deadline);
+}
+
+// =============================================================================
+// Sleeps until `deadline` is reached.
+__attribute__((target("waitpkg"))) void TimedSleep(uint64_t deadline) {
+  _tpause(kC01State, deadline);
+}
+
+}  // namespace
+
+// =============================================================================
+bool cpu_has_waitpkg() {
+  static const bool has_waitpkg = DetectWaitPkg();
+  return has_waitpkg;
+}
+
+// =============================================================================
+void MonitorWaitPolicy::operator()() {
+  if (!cpu_has_waitpkg()) {
+    cpu_pause();
+  } else if (address_ == nullptr) {
+    TimedSleep(__rdtsc() + max_cycles_);
+  } else {
+    Monitor(address_);
+    // Only sleep if the word is unchanged since before the caller checked its
+    // condition. Otherwise, the write may have come before the monitor.
+    if (has_value_ && Load(address_) == value_)
+      MonitoredSleep(__rdtsc() + max_cycles_);
+  }
+  if (address_ != nullptr) {
+    value_ = Load(address_);
+    has_value_ = true;
+  }
+}
+
+}  // namespace modcncy
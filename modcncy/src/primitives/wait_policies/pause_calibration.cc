@@ -0,0 +1,45 @@
+// Copyright 2022 The Modcncy Authors. All rights reserved.
+// Use of this source code is governed by the license found in the LICENSE file.
+// -----------------------------------------------------------------------------
+
+#include <chrono>  // NOLINT(build/c++11)
+
+#include "modcncy/include/modcncy/wait_policy.h"
+
+namespace modcncy {
+namespace {
+
+// Number of pauses timed together, so the clock overhead is negligible.
+constexpr int kPausesPerSample = 1000;
+
+// Number of samples. The fastest one is kept, since a preempted or interrupted
+// sample can only be slower.
+constexpr int kNumSamples = 10;
+
+// Lower bound of the measured latency, so it is always a valid divisor.
+constexpr double kMinLatencyNs = 0.1;
+
+// =============================================================================
+double MeasurePauseLatencyNs() {
+  double latency_ns = 0.0;
+  for (int sample = 0; sample < kNumSamples; ++sample) {
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kPausesPerSample; ++i) cpu_pause();
+    const auto stop = std::chrono::steady_clock::now();
+    const double sample_ns =
+        std::chrono::duration<double, std::nano>(stop - start).count() /
+        kPausesPerSample;
+    if (sample == 0 || sample_ns < latency_ns) latency_ns = sample_ns;
+  }
+  return latency_ns < kMinLatencyNs ? kMinLatencyNs : latency_ns;
+}
+
+}  // namespace
+
+// =============================================================================
+double cpu_pause_latency_ns() {
+  static const double latency_ns = MeasurePauseLatencyNs();
+  return latency_ns;
+}
+
+}  // namespace modcncy
@@ -0,0 +1,156 @@
+// Copyright 2022 The Modcncy Authors. All rights reserved.
+// Use of this source code is governed by the license found in the LICENSE file.
+// -----------------------------------------------------------------------------
+
+#include "modcncy/src/topology/cpu_topology.h"
+
+#include <sched.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+namespace modcncy {
+namespace topology {
+namespace {
+
+// Directory where Linux exposes the CPUs of the host.
+constexpr char kSysCpuDir[] = "/sys/devices/system/cpu";
+
+// Directory where Linux exposes the NUMA nodes of the host.
+constexpr char kSysNodeDir[] = "/sys/devices/system/node";
+
+// =============================================================================
+// Parses a non-negative decimal integer spanning the whole `str`.
+// On success, stores it in `*value` and returns `true`.
+bool ParseNonNegative(const std::string& str, int* value) {
+  if (str.empty()) return false;
+  char* end = nullptr;
+  const long parsed = std::strtol(str.c_str(), &end, 10);  // NOLINT
+  if (*end != '\0' || parsed < 0) return false;
+  *value = static_cast<int>(parsed);
+  return true;
+}
+
+}  // namespace
+
+// =============================================================================
+std::vector<int> ParseCpuList(const std::string& cpu_list) {
+  std::vector<int> cpus;
+  std::stringstream stream(cpu_list);
+  std::string range;
+  while (std::getline(stream, range, ',')) {
+    const size_t dash = range.find('-');
+    int first = 0;
+    int last = 0;
+    if (!ParseNonNegative(range.substr(0, dash), &first)) return {};
+    if (dash == std::string::npos) {
+      last = first;
+    } else if (!ParseNonNegative(range.substr(dash + 1), &last) ||
+               last < first) {
+      return {};
+    }
+    for (int cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+  }
+  return cpus;
+}
+
+// =============================================================================
+bool ReadLine(const std::string& path, std::string* line) {
+  std::ifstream file(path);
+  return file && std::getline(file, *line);
+}
+
+// =============================================================================
+std::vector<int> ReadAllowedCpus() {
+  std::vector<int> cpus;
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  if (sched_getaffinity(getpid(), sizeof(cpu_set), &cpu_set) != 0) return cpus;
+  for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+    if (CPU_ISSET(cpu, &cpu_set)) cpus.push_back(cpu);
+  return cpus;
+}
+
+// =============================================================================
+CpuTopology ReadCpuTopology() {
+  const std::vector<int> allowed = ReadAllowedCpus();
+  CpuTopology topology;
+  topology.num_cpus =
+      allowed.empty()
+          ? std::max(1, static_cast<int>(std::thread::hardware_concurrency()))
+          : static_cast<int>(allowed.size());
+  topology.num_sockets = 1;
+
+  std::string online;
+  if (!ReadLine(std::string(kSysCpuDir) + "/online", &online)) return topology;
+  std::vector<int> cpus = ParseCpuList(online);
+  if (cpus.empty()) return topology;
+
+  // Leave out the CPUs the process may not run on.
+  if (!allowed.empty()) {
+    std::vector<int> online_allowed;
+    std::set_intersection(cpus.begin(), cpus.end(), allowed.begin(),
+                          allowed.end(), std::back_inserter(online_allowed));
+    if (!online_allowed.empty()) cpus.swap(online_allowed);
+  }
+
+  std::set<std::string> sockets;
+  for (int cpu : cpus) {
+    std::string socket;
+    if (ReadLine(std::string(kSysCpuDir) + "/cpu" + std::to_string(cpu) +
+                     "/topology/physical_package_id",
+                 &socket)) {
+      sockets.insert(socket);
+    }
+  }
+  topology.num_cpus = static_cast<int>(cpus.size());
+  if (!sockets.empty()) topology.num_sockets = static_cast<int>(sockets.size());
+  return topology;
+}
+
+// =============================================================================
+NumaTopology ReadNumaTopology() {
+  NumaTopology topology;
+  std::string online;
+  if (ReadLine(std::string(kSysNodeDir) + "/online", &online)) {
+    for (int node : ParseCpuList(online)) {
+      std::string cpu_list;
+      if (!ReadLine(std::string(kSysNodeDir) + "/node" + std::to_string(node) +
+                        "/cpulist",
+                    &cpu_list))
+        continue;
+      const std::vector<int> cpus = ParseCpuList(cpu_list);
+      if (cpus.empty()) continue;  // Memory-only node.
+      const int dense_node = static_cast<int>(topology.cpus_of_node.size());
+      for (int cpu : cpus) {
+        if (cpu >= static_cast<int>(topology.node_of_cpu.size()))
+          topology.node_of_cpu.resize(cpu + 1, 0);
+        topology.node_of_cpu[cpu] = dense_node;
+      }
+      topology.cpus_of_node.push_back(cpus);
+    }
+  }
+
+  if (topology.cpus_of_node.empty()) {
+    // Single node with all CPUs the process may run on.
+    std::vector<int> cpus = ReadAllowedCpus();
+    if (cpus.empty()) {
+      const int num_cpus = ReadCpuTopology().num_cpus;
+      for (int cpu = 0; cpu < num_cpus; ++cpu) cpus.push_back(cpu);
+    }
+    topology.node_of_cpu.assign(cpus.back() + 1, 0);
+    topology.cpus_of_node.push_back(cpus);
+  }
+  return topology;
+}
+
+}  // namespace topology
+}  // namespace modcncy
@@ -0,0 +1,69 @@
+// Copyright 2022 The Modcncy Authors. All rights reserved.
+// Use of this source code is governed by the license found in the LICENSE file.
+// -----------------------------------------------------------------------------
+//
+// Utilities to discover the layout of the CPUs of the host, as exposed by Linux
+// under `/sys/devices/system/cpu` and `/sys/devices/system/node`.
+//
+// When the layout cannot be read, the host is assumed to be a single socket and
+// a single NUMA node with `std::thread::hardware_concurrency()` CPUs.
+//
+// The CPUs a process may use can be restricted further, such as by `taskset` or
+// a cpuset. `ReadCpuTopology()` only counts the CPUs allowed to the process.
+//
+// -----------------------------------------------------------------------------
+
+#ifndef MODCNCY_SRC_TOPOLOGY_CPU_TOPOLOGY_H_
+#define MODCNCY_SRC_TOPOLOGY_CPU_TOPOLOGY_H_
+
+#include <string>
+#include <vector>
+
+namespace modcncy {
+namespace topology {
+
+// Layout of the online CPUs of the host allowed to the process.
+struct CpuTopology {
+  // Number of online CPUs allowed to the process.
+  int num_cpus;
+  // Number of sockets (physical packages) with at least one of those CPUs.
+  int num_sockets;
+};  // struct CpuTopology
+
+// Layout of the NUMA nodes of the host.
+struct NumaTopology {
+  // CPUs of each NUMA node. Nodes are numbered densely from 0.
+  std::vector<std::vector<int>> cpus_of_node;
+  // NUMA node of each CPU, or 0 if unknown.
+  std::vector<int> node_of_cpu;
+
+  // Returns the NUMA node of `cpu`.
+  int NodeOf(int cpu) const {
+    return cpu >= 0 && cpu < static_cast<int>(node_of_cpu.size())
+               ? node_of_cpu[cpu]
+               : 0;
+  }
+};  // struct NumaTopology
+
+// Parses a Linux CPU list, such as "0-3,8,10-11", into the list of CPUs.
+// Returns an empty list if `cpu_list` is malformed.
+std::vector<int> ParseCpuList(const std::string& cpu_list);
+
+// Reads the first line of the file at `path` into `*line`.
+// Returns `false` if the file cannot be read.
+bool ReadLine(const std::string& path, std::string* line);
+
+// Returns the CPUs in the affinity mask of the process, as set on its main
+// thread. Returns an empty list if the mask cannot be read.
+std::vector<int> ReadAllowedCpus();
+
+// Returns the layout of the online CPUs of the host allowed to the process.
+CpuTopology ReadCpuTopology();
+
+// Returns the layout of the NUMA nodes of the host, with at least one node.
+NumaTopology ReadNumaTopology();
+
+}  // namespace topology
+}  // namespace modcncy
+
+#endif  // MODCNCY_SRC_TOPOLOGY_CPU_TOPOLOGY_H_
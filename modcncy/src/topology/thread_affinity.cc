@@ -0,0 +1,89 @@
+// Copyright 2022 The Modcncy Authors. All rights reserved.
+// Use of this source code is governed by the license found in the LICENSE file.
+// -----------------------------------------------------------------------------
+
+#include "modcncy/include/modcncy/thread_affinity.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <vector>
+
+#include "modcncy/src/topology/cpu_topology.h"
+
+namespace modcncy {
+namespace {
+
+// CPUs the calling thread was allowed to run on before it was first pinned.
+thread_local bool has_original_cpu_set = false;
+thread_local cpu_set_t original_cpu_set;
+
+// Returns the CPUs in `allowed_cpu_set` in the order threads are pinned to
+// them: first CPU of each node, then second CPU of each node, and so on.
+std::vector<int> PinnableCpus(const cpu_set_t& allowed_cpu_set) {
+  const topology::NumaTopology numa = topology::ReadNumaTopology();
+  std::vector<std::vector<int>> allowed_cpus_of_node;
+  for (const auto& cpus_of_node : numa.cpus_of_node) {
+    allowed_cpus_of_node.emplace_back();
+    for (int cpu : cpus_of_node)
+      if (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed_cpu_set))
+        allowed_cpus_of_node.back().push_back(cpu);
+  }
+  std::vector<int> cpus;
+  for (size_t round = 0;; ++round) {
+    const size_t num_cpus = cpus.size();
+    for (const auto& cpus_of_node : allowed_cpus_of_node)
+      if (round < cpus_of_node.size()) cpus.push_back(cpus_of_node[round]);
+    if (cpus.size() == num_cpus) break;
+  }
+  return cpus;
+}
+
+}  // namespace
+
+// =============================================================================
+int NumNumaNodes() {
+  return static_cast<int>(topology::ReadNumaTopology().cpus_of_node.size());
+}
+
+// =============================================================================
+bool PinThreadAcrossNodes(int thread_index) {
+  if (thread_index < 0) return false;
+  if (!has_original_cpu_set) {
+    if (pthread_getaffinity_np(pthread_self(), sizeof(original_cpu_set),
+                               &original_cpu_set) != 0)
+      return false;
+    has_original_cpu_set = true;
+  }
+  const std::vector<int> cpus = PinnableCpus(original_cpu_set);
+  if (cpus.empty()) return false;
+  const int cpu = cpus[thread_index % cpus.size()];
+
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  CPU_SET(cpu, &cpu_set);
+  return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) == 0;
+}
+
+// =============================================================================
+int NumPinnableCpus() {
+  cpu_set_t cpu_set;
+  if (has_original_cpu_set)
+    cpu_set = original_cpu_set;
+  else if (pthread_getaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) !=
+           0)
+    return 0;
+  return static_cast<int>(PinnableCpus(cpu_set).size());
+}
+
+// =============================================================================
+bool UnpinThread() {
+  if (!has_original_cpu_set) return true;
+  if (pthread_setaffinity_np(pthread_self(), sizeof(original_cpu_set),
+                             &original_cpu_set) != 0)
+    return false;
+  has_original_cpu_set = false;
+  return true;
+}
+
+}  // namespace modcncy
@@ -28,12 +28,30 @@ TEST(BarrierCreationTest, CreateUnsupportedBarrier) {
   delete barrier;
 }
 
+// =============================================================================
+TEST(BarrierCreationTest, CreateAdaptiveBarrierForAnyNumberOfThreads) {
+  for (int num_threads : {0, 1, 4, 64, 1024}) {
+    auto barrier = Barrier::Create(BarrierType::kAdaptive, num_threads);
+    // Some barrier should be selected.
+    EXPECT_NE(barrier, nullptr);
+    // Teardown.
+    delete barrier;
+  }
+}
+
 class BarrierBehaviorTest : public testing::TestWithParam<BarrierType> {};
 
 INSTANTIATE_TEST_SUITE_P(
     AllBarrierTypes, BarrierBehaviorTest,
     testing::Values(BarrierType::kCentralSenseCounterBarrier,
-                    BarrierType::kCentralStepCounterBarrier));
+                    BarrierType::kCentralStepCounterBarrier,
+                    BarrierType::kCombiningTreeBarrier,
+                    BarrierType::kDisseminationBarrier,
+                    BarrierType::kTournamentBarrier,
+                    BarrierType::kStaticTreeBarrier,
+                    BarrierType::kSpinThenParkBarrier,
+                    BarrierType::kAdaptive,
+                    BarrierType::kNumaHierarchicalBarrier));
 
 // =============================================================================
 TEST_P(BarrierBehaviorTest, CreateBarrier) {
@@ -254,5 +272,135 @@ TEST_P(BarrierBehaviorTest, ReusableAndAdaptableBarrierBySortingSegments) {
   delete barrier;
 }
 
+// =============================================================================
+TEST_P(BarrierBehaviorTest, ReusableBarrierWithThreadIds) {
+  // Setup.
+  auto barrier = Barrier::Create(/*type=*/GetParam());
+  EXPECT_NE(barrier, nullptr);
+  constexpr int num_threads = 16;
+  constexpr int num_steps = 1000;
+  std::vector<int> values(num_threads, 0);
+
+  // At every step, each thread publishes its value and reads the value of its
+  // neighbor. A second barrier makes sure that nobody overwrites a value that
+  // is still being read.
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads);
+  for (int thread_index = 0; thread_index < num_threads; ++thread_index) {
+    threads.emplace_back([&, thread_index] {
+      const int neighbor_index = (thread_index + 1) % num_threads;
+      for (int step = 1; step <= num_steps; ++step) {
+        values[thread_index] = step;
+        barrier->Wait(num_threads, /*thread_id=*/thread_index);
+        EXPECT_EQ(values[neighbor_index], step);
+        barrier->Wait(num_threads, /*thread_id=*/thread_index);
+      }
+    });
+  }
+
+  // Teardown.
+  for (auto& thread : threads) thread.join();
+  delete barrier;
+}
+
+// =============================================================================
+TEST_P(BarrierBehaviorTest, ReusableSplitPhaseBarrier) {
+  // Setup.
+  auto barrier = Barrier::Create(/*type=*/GetParam());
+  EXPECT_NE(barrier, nullptr);
+  constexpr int num_threads = 16;
+  constexpr int num_steps = 1000;
+  std::vector<int> values(num_threads, 0);
+  std::vector<int> local_values(num_threads, 0);
+
+  // At every step, each thread publishes its value and prepares some local
+  // work between its arrival and its wait. Only then it reads the value of its
+  // neighbor. A second barrier makes sure that nobody overwrites a value that
+  // is still being read.
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads);
+  for (int thread_index = 0; thread_index < num_threads; ++thread_index) {
+    threads.emplace_back([&, thread_index] {
+      const int neighbor_index = (thread_index + 1) % num_threads;
+      for (int step = 1; step <= num_steps; ++step) {
+        values[thread_index] = step;
+        const Barrier::Token token = barrier->Arrive(num_threads);
+        local_values[thread_index] += step;
+        barrier->Wait(token);
+        EXPECT_EQ(values[neighbor_index], step);
+        barrier->Wait(barrier->Arrive(num_threads));
+      }
+      EXPECT_EQ(local_values[thread_index], num_steps * (num_steps + 1) / 2);
+    });
+  }
+
+  // Teardown.
+  for (auto& thread : threads) thread.join();
+  delete barrier;
+}
+
+// =============================================================================
+TEST_P(BarrierBehaviorTest, ArriveReturnsBeforeAllThreadsArrive) {
+  // These barriers keep the default `Arrive()`, which blocks.
+  if (GetParam() == BarrierType::kDisseminationBarrier ||
+      GetParam() == BarrierType::kTournamentBarrier ||
+      GetParam() == BarrierType::kStaticTreeBarrier)
+    GTEST_SKIP();
+
+  // Setup.
+  constexpr int num_threads = 2;
+  auto barrier = Barrier::Create(/*type=*/GetParam(), num_threads);
+  EXPECT_NE(barrier, nullptr);
+
+  // The main thread arrives first, and only waits once the other thread runs.
+  const Barrier::Token token = barrier->Arrive(num_threads);
+  std::thread thread([&] { barrier->Wait(barrier->Arrive(num_threads)); });
+  barrier->Wait(token);
+
+  // Teardown.
+  thread.join();
+  delete barrier;
+}
+
+// =============================================================================
+TEST_P(BarrierBehaviorTest, CompletionRunsOncePerBarrierSynchronization) {
+  // Setup.
+  auto barrier = Barrier::Create(/*type=*/GetParam());
+  EXPECT_NE(barrier, nullptr);
+  constexpr int num_threads = 16;
+  constexpr int num_steps = 1000;
+  std::vector<int> values(num_threads, 0);
+  int completed_steps = 0;
+  int sum = 0;
+
+  // The completion function runs serially between two barrier
+  // synchronizations, so it can freely read what every thread published.
+  barrier->SetCompletion([&] {
+    ++completed_steps;
+    for (int value : values) sum += value;
+  });
+
+  // At every step, each thread publishes its value and, once released, checks
+  // that the completion function has already seen all values of this step.
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads);
+  for (int thread_index = 0; thread_index < num_threads; ++thread_index) {
+    threads.emplace_back([&, thread_index] {
+      for (int step = 1; step <= num_steps; ++step) {
+        values[thread_index] = step;
+        barrier->Wait(num_threads);
+        EXPECT_EQ(completed_steps, 2 * step - 1);
+        EXPECT_EQ(sum, num_threads * step * step);
+        barrier->Wait(num_threads);
+      }
+    });
+  }
+
+  // Teardown.
+  for (auto& thread : threads) thread.join();
+  EXPECT_EQ(completed_steps, 2 * num_steps);
+  delete barrier;
+}
+
 }  // namespace
 }  // namespace modcncy
@@ -5,7 +5,9 @@
 #include <gtest/gtest.h>
 #include <modcncy/barrier.h>
 #include <modcncy/concurrent_task_queue.h>
+#include <modcncy/task.h>
 
+#include <atomic>
 #include <mutex>   // NOLINT(build/c++11)
 #include <thread>  // NOLINT(build/c++11)
 #include <vector>
@@ -29,7 +31,9 @@ class ConcurrentTaskQueueBehaviorTest
 
 INSTANTIATE_TEST_SUITE_P(
     AllConcurrentTaskQueueTypes, ConcurrentTaskQueueBehaviorTest,
-    testing::Values(ConcurrentTaskQueueType::kBlockingTaskQueue));
+    testing::Values(ConcurrentTaskQueueType::kBlockingTaskQueue,
+                    ConcurrentTaskQueueType::kBoundedLockFreeTaskQueue,
+                    ConcurrentTaskQueueType::kUnboundedLockFreeTaskQueue));
 
 // =============================================================================
 TEST_P(ConcurrentTaskQueueBehaviorTest, CreateConcurrentQueue) {
@@ -63,7 +67,7 @@ TEST_P(ConcurrentTaskQueueBehaviorTest, ConcurrentTaskQueueExecution) {
         ++counter;
       });
       // Each thread pops a task and executes it.
-      std::function<void()> task = std::move(queue->Pop());
+      Task<> task = queue->Pop();
       task();
       // Wait until all threads have executed one task.
       barrier->Wait(num_threads);
@@ -78,5 +82,398 @@ TEST_P(ConcurrentTaskQueueBehaviorTest, ConcurrentTaskQueueExecution) {
   delete queue;
 }
 
+// =============================================================================
+TEST_P(ConcurrentTaskQueueBehaviorTest, PopsTasksInFifoOrder) {
+  // Setup.
+  auto queue = ConcurrentTaskQueue::Create(/*type=*/GetParam());
+  constexpr int num_tasks = 100;
+  std::vector<int> order;
+
+  // Tasks are popped in the order they were pushed, and then none is left.
+  for (int i = 0; i < num_tasks; ++i)
+    queue->Push([&, i] { order.push_back(i); });
+  for (int i = 0; i < num_tasks; ++i) {
+    Task<> task = queue->Pop();
+    ASSERT_NE(task, nullptr);
+    task();
+    EXPECT_EQ(order.back(), i);
+  }
+  EXPECT_EQ(queue->Pop(), nullptr);
+
+  // Teardown.
+  delete queue;
+}
+
+// =============================================================================
+TEST_P(ConcurrentTaskQueueBehaviorTest, PushesAndPopsBatchesInFifoOrder) {
+  // Setup.
+  auto queue = ConcurrentTaskQueue::Create(/*type=*/GetParam());
+  constexpr int num_tasks = 100;
+  constexpr size_t max_batch_size = 7;
+  std::vector<int> order;
+  std::vector<Task<>> tasks;
+  for (int i = 0; i < num_tasks; ++i)
+    tasks.push_back([&, i] { order.push_back(i); });
+
+  // Batches keep the order tasks were pushed in, and then none is left.
+  queue->PushBulk(tasks.data(), tasks.data() + num_tasks);
+  Task<> batch[max_batch_size];
+  int num_popped = 0;
+  while (num_popped < num_tasks) {
+    const size_t batch_size = queue->PopBatch(batch, max_batch_size);
+    ASSERT_GT(batch_size, 0u);
+    for (size_t i = 0; i < batch_size; ++i) {
+      batch[i]();
+      EXPECT_EQ(order.back(), num_popped++);
+    }
+  }
+  EXPECT_EQ(queue->PopBatch(batch, max_batch_size), 0u);
+
+  // Teardown.
+  delete queue;
+}
+
+// =============================================================================
+TEST_P(ConcurrentTaskQueueBehaviorTest, BulkProducersAndBatchConsumers) {
+  // Setup.
+  auto queue = ConcurrentTaskQueue::Create(/*type=*/GetParam(), /*capacity=*/8);
+  constexpr int num_producers = 4;
+  constexpr int num_consumers = 4;
+  constexpr int num_batches_per_producer = 100;
+  constexpr int num_tasks_per_batch = 10;
+  constexpr int num_tasks =
+      num_producers * num_batches_per_producer * num_tasks_per_batch;
+  std::vector<std::atomic<int>> num_runs(num_tasks);
+  for (auto& runs : num_runs) runs.store(0);
+  std::atomic<int> num_executed{0};
+
+  // Every task pushed in a batch is executed exactly once.
+  std::vector<std::thread> threads;
+  threads.reserve(num_producers + num_consumers);
+  for (int i = 0; i < num_producers; ++i) {
+    threads.emplace_back([&, i] {
+      Task<> batch[num_tasks_per_batch];
+      for (int j = 0; j < num_batches_per_producer; ++j) {
+        for (int k = 0; k < num_tasks_per_batch; ++k) {
+          const int task_id =
+              (i * num_batches_per_producer + j) * num_tasks_per_batch + k;
+          batch[k] = [&, task_id] { num_runs[task_id].fetch_add(1); };
+        }
+        queue->PushBulk(batch, batch + num_tasks_per_batch);
+      }
+    });
+  }
+  for (int i = 0; i < num_consumers; ++i) {
+    threads.emplace_back([&] {
+      Task<> batch[num_tasks_per_batch];
+      while (num_executed.load() < num_tasks) {
+        const size_t batch_size = queue->PopBatch(batch, num_tasks_per_batch);
+        if (batch_size == 0) std::this_thread::yield();
+        for (size_t j = 0; j < batch_size; ++j) batch[j]();
+        num_executed.fetch_add(batch_size);
+      }
+    });
+  }
+
+  // Teardown.
+  for (auto& thread : threads) thread.join();
+  for (int i = 0; i < num_tasks; ++i) EXPECT_EQ(num_runs[i].load(), 1);
+  EXPECT_EQ(queue->Pop(), nullptr);
+  delete queue;
+}
+
+// =============================================================================
+TEST(ConcurrentTaskQueueStealHalfTest, StealsHalfOfTheVictimTasks) {
+  constexpr int num_tasks = 9;
+  for (ConcurrentTaskQueueType type :
+       {ConcurrentTaskQueueType::kBlockingTaskQueue,
+        ConcurrentTaskQueueType::kBoundedLockFreeTaskQueue,
+        ConcurrentTaskQueueType::kWorkStealingTaskDeque,
+        ConcurrentTaskQueueType::kUnboundedLockFreeTaskQueue}) {
+    // Setup.
+    auto victim = ConcurrentTaskQueue::Create(type);
+    auto thief = ConcurrentTaskQueue::Create(type);
+    std::vector<int> order;
+    for (int i = 0; i < num_tasks; ++i)
+      victim->Push([&, i] { order.push_back(i); });
+
+    // The thief takes the oldest half of the tasks, rounded up, or a single
+    // task from queues unable to tell how many tasks they hold.
+    const size_t expected_num_stolen =
+        type == ConcurrentTaskQueueType::kUnboundedLockFreeTaskQueue
+            ? 1
+            : (num_tasks + 1) / 2;
+    EXPECT_EQ(thief->StealHalf(victim), expected_num_stolen);
+    for (;;) {
+      Task<> task = thief->Pop();
+      if (task == nullptr) break;
+      task();
+    }
+    ASSERT_EQ(order.size(), expected_num_stolen);
+    for (size_t i = 0; i < expected_num_stolen; ++i)
+      EXPECT_TRUE(order[i] < static_cast<int>(expected_num_stolen));
+
+    // Teardown.
+    delete victim;
+    delete thief;
+  }
+}
+
+// =============================================================================
+TEST(BoundedLockFreeTaskQueueTest, ProducerWaitsWhileFull) {
+  // Setup.
+  auto queue = ConcurrentTaskQueue::Create(
+      ConcurrentTaskQueueType::kBoundedLockFreeTaskQueue, /*capacity=*/4);
+  constexpr int num_tasks = 1000;
+  std::vector<int> order;
+
+  // The producer pushes many more tasks than fit, so it waits for the consumer
+  // to pop them, and the ring wraps around many times.
+  std::thread producer([&] {
+    for (int i = 0; i < num_tasks; ++i)
+      queue->Push([&, i] { order.push_back(i); });
+  });
+  while (order.size() < static_cast<size_t>(num_tasks)) {
+    Task<> task = queue->Pop();
+    if (task == nullptr)
+      std::this_thread::yield();
+    else
+      task();
+  }
+
+  // Teardown.
+  producer.join();
+  EXPECT_EQ(queue->Pop(), nullptr);
+  for (int i = 0; i < num_tasks; ++i) EXPECT_EQ(order[i], i);
+  delete queue;
+}
+
+// =============================================================================
+TEST(BoundedLockFreeTaskQueueTest, ManyProducersAndConsumers) {
+  // Setup.
+  auto queue = ConcurrentTaskQueue::Create(
+      ConcurrentTaskQueueType::kBoundedLockFreeTaskQueue, /*capacity=*/8);
+  constexpr int num_producers = 4;
+  constexpr int num_consumers = 4;
+  constexpr int num_tasks_per_producer = 1000;
+  constexpr int num_tasks = num_producers * num_tasks_per_producer;
+  std::atomic<int> num_executed{0};
+  std::atomic<int> sum{0};
+
+  // Every task pushed is executed exactly once.
+  std::vector<std::thread> threads;
+  threads.reserve(num_producers + num_consumers);
+  for (int i = 0; i < num_producers; ++i) {
+    threads.emplace_back([&, i] {
+      for (int j = 0; j < num_tasks_per_producer; ++j) {
+        const int value = i * num_tasks_per_producer + j;
+        queue->Push([&, value] {
+          sum.fetch_add(value);
+          num_executed.fetch_add(1);
+        });
+      }
+    });
+  }
+  for (int i = 0; i < num_consumers; ++i) {
+    threads.emplace_back([&] {
+      while (num_executed.load() < num_tasks) {
+        Task<> task = queue->Pop();
+        if (task == nullptr)
+          std::this_thread::yield();
+        else
+          task();
+      }
+    });
+  }
+
+  // Teardown.
+  for (auto& thread : threads) thread.join();
+  EXPECT_EQ(num_executed.load(), num_tasks);
+  EXPECT_EQ(sum.load(), num_tasks * (num_tasks - 1) / 2);
+  EXPECT_EQ(queue->Pop(), nullptr);
+  delete queue;
+}
+
+// =============================================================================
+TEST(WorkStealingTaskDequeTest, OwnerPopsNewestAndThievesStealOldest) {
+  // Setup.
+  auto deque = ConcurrentTaskQueue::Create(
+      ConcurrentTaskQueueType::kWorkStealingTaskDeque, /*capacity=*/4);
+  constexpr int num_tasks = 100;
+  std::vector<int> order;
+
+  // Pushing many more tasks than the initial capacity grows the deque.
+  for (int i = 0; i < num_tasks; ++i)
+    deque->Push([&, i] { order.push_back(i); });
+
+  // Thieves take the oldest task, and the owner the newest one.
+  for (int i = 0; i < num_tasks / 2; ++i) {
+    Task<> stolen_task = deque->Steal();
+    ASSERT_NE(stolen_task, nullptr);
+    stolen_task();
+    EXPECT_EQ(order.back(), i);
+    Task<> popped_task = deque->Pop();
+    ASSERT_NE(popped_task, nullptr);
+    popped_task();
+    EXPECT_EQ(order.back(), num_tasks - i - 1);
+  }
+  EXPECT_EQ(deque->Pop(), nullptr);
+  EXPECT_EQ(deque->Steal(), nullptr);
+
+  // Teardown.
+  delete deque;
+}
+
+// =============================================================================
+TEST(WorkStealingTaskDequeTest, OwnerAndThievesRunEveryTaskOnce) {
+  // Setup.
+  auto deque = ConcurrentTaskQueue::Create(
+      ConcurrentTaskQueueType::kWorkStealingTaskDeque, /*capacity=*/8);
+  constexpr int num_thieves = 4;
+  constexpr int num_rounds = 100;
+  constexpr int num_tasks_per_round = 100;
+  constexpr int num_tasks = num_rounds * num_tasks_per_round;
+  std::vector<std::atomic<int>> num_runs(num_tasks);
+  for (auto& runs : num_runs) runs.store(0);
+  std::atomic<bool> done{false};
+
+  // The owner pushes rounds of tasks and pops them, racing the thieves for the
+  // last ones, while the deque grows and shrinks.
+  std::vector<std::thread> thieves;
+  thieves.reserve(num_thieves);
+  for (int i = 0; i < num_thieves; ++i) {
+    thieves.emplace_back([&] {
+      while (!done.load()) {
+        Task<> task = deque->Steal();
+        if (task == nullptr)
+          std::this_thread::yield();
+        else
+          task();
+      }
+    });
+  }
+  for (int round = 0; round < num_rounds; ++round) {
+    for (int i = 0; i < num_tasks_per_round; ++i) {
+      const int task_id = round * num_tasks_per_round + i;
+      deque->Push([&, task_id] { num_runs[task_id].fetch_add(1); });
+    }
+    for (;;) {
+      Task<> task = deque->Pop();
+      if (task == nullptr) break;
+      task();
+    }
+  }
+
+  // Teardown.
+  done.store(true);
+  for (auto& thief : thieves) thief.join();
+  for (int i = 0; i < num_tasks; ++i) EXPECT_EQ(num_runs[i].load(), 1);
+  delete deque;
+}
+
+// =============================================================================
+TEST(WorkStealingTaskDequeTest, ThievesStealHalfIntoTheirOwnDeques) {
+  // Setup.
+  auto deque = ConcurrentTaskQueue::Create(
+      ConcurrentTaskQueueType::kWorkStealingTaskDeque, /*capacity=*/8);
+  constexpr int num_thieves = 4;
+  constexpr int num_rounds = 100;
+  constexpr int num_tasks_per_round = 100;
+  constexpr int num_tasks = num_rounds * num_tasks_per_round;
+  std::vector<std::atomic<int>> num_runs(num_tasks);
+  for (auto& runs : num_runs) runs.store(0);
+  std::atomic<bool> done{false};
+
+  // The owner pushes rounds of tasks in bulk and pops them, while thieves move
+  // half of them at a time into their own deques, and run them from there.
+  std::vector<std::thread> thieves;
+  thieves.reserve(num_thieves);
+  for (int i = 0; i < num_thieves; ++i) {
+    thieves.emplace_back([&] {
+      auto own_deque = ConcurrentTaskQueue::Create(
+          ConcurrentTaskQueueType::kWorkStealingTaskDeque, /*capacity=*/8);
+      while (!done.load()) {
+        if (own_deque->StealHalf(deque) == 0) std::this_thread::yield();
+        for (;;) {
+          Task<> task = own_deque->Pop();
+          if (task == nullptr) break;
+          task();
+        }
+      }
+      delete own_deque;
+    });
+  }
+  std::vector<Task<>> tasks(num_tasks_per_round);
+  for (int round = 0; round < num_rounds; ++round) {
+    for (int i = 0; i < num_tasks_per_round; ++i) {
+      const int task_id = round * num_tasks_per_round + i;
+      tasks[i] = [&, task_id] { num_runs[task_id].fetch_add(1); };
+    }
+    deque->PushBulk(tasks.data(), tasks.data() + num_tasks_per_round);
+    for (;;) {
+      Task<> task = deque->Pop();
+      if (task == nullptr) break;
+      task();
+    }
+  }
+
+  // Teardown.
+  done.store(true);
+  for (auto& thief : thieves) thief.join();
+  for (int i = 0; i < num_tasks; ++i) EXPECT_EQ(num_runs[i].load(), 1);
+  delete deque;
+}
+
+// =============================================================================
+TEST(UnboundedLockFreeTaskQueueTest, ProducersAndConsumersComeAndGo) {
+  // Setup.
+  auto queue = ConcurrentTaskQueue::Create(
+      ConcurrentTaskQueueType::kUnboundedLockFreeTaskQueue);
+  constexpr int num_rounds = 10;
+  constexpr int num_producers = 2;
+  constexpr int num_consumers = 2;
+  constexpr int num_tasks_per_producer = 1000;
+  constexpr int num_tasks_per_round = num_producers * num_tasks_per_producer;
+  constexpr int num_tasks = num_rounds * num_tasks_per_round;
+  std::vector<std::atomic<int>> num_runs(num_tasks);
+  for (auto& runs : num_runs) runs.store(0);
+
+  // Every round runs new threads, which reuse the nodes and the hazard pointers
+  // left behind by the threads of the previous rounds.
+  for (int round = 0; round < num_rounds; ++round) {
+    std::atomic<int> num_executed{0};
+    std::vector<std::thread> threads;
+    threads.reserve(num_producers + num_consumers);
+    for (int i = 0; i < num_producers; ++i) {
+      threads.emplace_back([&, round, i] {
+        for (int j = 0; j < num_tasks_per_producer; ++j) {
+          const int task_id = round * num_tasks_per_round +
+                              i * num_tasks_per_producer + j;
+          queue->Push([&, task_id] { num_runs[task_id].fetch_add(1); });
+        }
+      });
+    }
+    for (int i = 0; i < num_consumers; ++i) {
+      threads.emplace_back([&] {
+        while (num_executed.load() < num_tasks_per_round) {
+          Task<> task = queue->Pop();
+          if (task == nullptr) {
+            std::this_thread::yield();
+          } else {
+            task();
+            num_executed.fetch_add(1);
+          }
+        }
+      });
+    }
+    for (auto& thread : threads) thread.join();
+    EXPECT_EQ(queue->Pop(), nullptr);
+  }
+
+  // Teardown.
+  for (int i = 0; i < num_tasks; ++i) EXPECT_EQ(num_runs[i].load(), 1);
+  delete queue;
+}
+
 }  // namespace
 }  // namespace modcncy
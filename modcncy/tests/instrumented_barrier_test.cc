@@ -0,0 +1,146 @@
+// Copyright 2022 The Modcncy Authors. All rights reserved.
+// Use of this source code is governed by the license found in the LICENSE file.
+// -----------------------------------------------------------------------------
+
+#include <gtest/gtest.h>
+#include <modcncy/barrier.h>
+#include <modcncy/instrumented_barrier.h>
+#include <modcncy/wait_policy.h>
+
+#include <algorithm>
+#include <chrono>  // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+namespace modcncy {
+namespace {
+
+// =============================================================================
+TEST(InstrumentedBarrierTest, ReusableInstrumentedBarrier) {
+  // Setup.
+  InstrumentedBarrier barrier(
+      Barrier::Create(BarrierType::kCentralSenseCounterBarrier));
+  constexpr int num_threads = 16;
+  constexpr int num_steps = 1000;
+  int completed_steps = 0;
+  barrier.SetCompletion([&] { ++completed_steps; });
+  std::vector<int> values(num_threads, 0);
+
+  // At every step, each thread publishes its value and reads the value of its
+  // neighbor. A second barrier makes sure that nobody overwrites a value that
+  // is still being read.
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads);
+  for (int thread_index = 0; thread_index < num_threads; ++thread_index) {
+    threads.emplace_back([&, thread_index] {
+      const int neighbor_index = (thread_index + 1) % num_threads;
+      for (int step = 1; step <= num_steps; ++step) {
+        values[thread_index] = step;
+        barrier.Wait(num_threads, thread_index);
+        EXPECT_EQ(values[neighbor_index], step);
+        barrier.Wait(barrier.Arrive(num_threads));
+      }
+    });
+  }
+
+  // Teardown.
+  for (auto& thread : threads) thread.join();
+  EXPECT_EQ(completed_steps, 2 * num_steps);
+  const BarrierStats stats = barrier.Snapshot();
+  EXPECT_EQ(stats.num_phases, 2u * num_steps);
+  EXPECT_EQ(stats.skew.count, 2u * num_steps);
+  EXPECT_EQ(stats.wait.count, 2u * num_steps * num_threads);
+  EXPECT_EQ(stats.phase_skews_ns.size(), 2u * num_steps);
+  EXPECT_LE(stats.skew.p50_ns, stats.skew.p90_ns);
+  EXPECT_LE(stats.skew.p90_ns, stats.skew.p99_ns);
+  EXPECT_LE(stats.skew.p99_ns, stats.skew.max_ns);
+}
+
+// =============================================================================
+TEST(InstrumentedBarrierTest, SkewReflectsLateArrivals) {
+  // Setup.
+  InstrumentedBarrier barrier(
+      Barrier::Create(BarrierType::kCentralStepCounterBarrier));
+  constexpr int num_threads = 2;
+  constexpr int num_steps = 5;
+  constexpr int64_t delay_ns = 20 * 1000 * 1000;
+
+  // One thread always arrives late, so the other waits for it.
+  std::thread late_thread([&] {
+    for (int step = 0; step < num_steps; ++step) {
+      std::this_thread::sleep_for(std::chrono::nanoseconds(delay_ns));
+      barrier.Wait(num_threads);
+    }
+  });
+  for (int step = 0; step < num_steps; ++step) barrier.Wait(num_threads);
+
+  // Teardown.
+  late_thread.join();
+  const BarrierStats stats = barrier.Snapshot();
+  EXPECT_EQ(stats.num_phases, 1u * num_steps);
+  // The early thread may be released a bit after the late one, and estimated
+  // percentiles are accurate within a quarter of a power of two.
+  EXPECT_GE(stats.skew.max_ns, delay_ns * 3 / 4);
+  EXPECT_GE(stats.skew.p50_ns, delay_ns / 2);
+  EXPECT_GE(stats.wait.max_ns, delay_ns * 3 / 4);
+  for (int64_t skew : stats.phase_skews_ns) EXPECT_GE(skew, delay_ns * 3 / 4);
+
+  // Both threads arrived at every phase, and only one of them late.
+  int64_t max_mean_lateness_ns = 0;
+  int64_t min_mean_lateness_ns = delay_ns;
+  uint64_t num_arrivals = 0;
+  for (const LatenessSummary& lateness : stats.thread_lateness) {
+    if (lateness.count == 0) continue;
+    max_mean_lateness_ns = std::max(max_mean_lateness_ns, lateness.mean_ns);
+    min_mean_lateness_ns = std::min(min_mean_lateness_ns, lateness.mean_ns);
+    num_arrivals += lateness.count;
+  }
+  EXPECT_EQ(num_arrivals, 1u * num_threads * num_steps);
+  EXPECT_GE(max_mean_lateness_ns, delay_ns * 3 / 4);
+  EXPECT_LT(min_mean_lateness_ns, delay_ns / 4);
+
+  // Statistics start over after a reset.
+  barrier.Reset();
+  EXPECT_EQ(barrier.Snapshot().num_phases, 0u);
+  EXPECT_TRUE(barrier.Snapshot().phase_skews_ns.empty());
+  EXPECT_TRUE(barrier.Snapshot().thread_lateness.empty());
+}
+
+// =============================================================================
+TEST(InstrumentedBarrierTest, WrappedBarrierOnlyRunsCompletionsSetByCaller) {
+  // Setup.
+  InstrumentedBarrier barrier(
+      Barrier::Create(BarrierType::kDisseminationBarrier));
+  EventCount event_count;
+  barrier.SetEventCount(&event_count);
+  constexpr int num_threads = 4;
+  constexpr int num_rounds = 2;
+  constexpr int num_steps = 100;
+  auto run_steps = [&] {
+    std::vector<std::thread> threads;
+    threads.reserve(num_threads);
+    for (int thread_index = 0; thread_index < num_threads; ++thread_index) {
+      threads.emplace_back([&, thread_index] {
+        for (int step = 0; step < num_steps; ++step)
+          barrier.Wait(num_threads, thread_index);
+      });
+    }
+    for (auto& thread : threads) thread.join();
+  };
+
+  // Every thread signals once per round, and goes through the rounds once.
+  run_steps();
+  EXPECT_EQ(event_count.Epoch(),
+            static_cast<unsigned>(num_steps * num_threads * num_rounds));
+
+  // With a completion set by the caller, it goes through them twice.
+  int completed_steps = 0;
+  barrier.SetCompletion([&] { ++completed_steps; });
+  run_steps();
+  EXPECT_EQ(completed_steps, num_steps);
+  EXPECT_EQ(event_count.Epoch(),
+            static_cast<unsigned>(3 * num_steps * num_threads * num_rounds));
+}
+
+}  // namespace
+}  // namespace modcncy
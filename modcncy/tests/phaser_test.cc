@@ -0,0 +1,114 @@
+// Copyright 2022 The Modcncy Authors. All rights reserved.
+// Use of this source code is governed by the license found in the LICENSE file.
+// -----------------------------------------------------------------------------
+
+#include <gtest/gtest.h>
+#include <modcncy/phaser.h>
+
+#include <atomic>
+#include <chrono>  // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+namespace modcncy {
+namespace {
+
+// =============================================================================
+TEST(PhaserTest, ReusablePhaser) {
+  // Setup.
+  constexpr int num_threads = 16;
+  constexpr int num_steps = 1000;
+  Phaser phaser(num_threads);
+  std::vector<int> values(num_threads, 0);
+
+  // At every step, each thread publishes its value and reads the value of its
+  // neighbor. A second phase makes sure that nobody overwrites a value that is
+  // still being read.
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads);
+  for (int thread_index = 0; thread_index < num_threads; ++thread_index) {
+    threads.emplace_back([&, thread_index] {
+      const int neighbor_index = (thread_index + 1) % num_threads;
+      for (int step = 1; step <= num_steps; ++step) {
+        values[thread_index] = step;
+        EXPECT_EQ(phaser.Wait(), 2u * step - 2);
+        EXPECT_EQ(values[neighbor_index], step);
+        EXPECT_EQ(phaser.Wait(), 2u * step - 1);
+      }
+    });
+  }
+
+  // Teardown.
+  for (auto& thread : threads) thread.join();
+}
+
+// =============================================================================
+TEST(PhaserTest, ParticipantsLeaveEarly) {
+  // Setup.
+  constexpr int num_threads = 16;
+  constexpr int num_steps_per_thread = 100;
+  Phaser phaser(num_threads);
+  std::vector<int> values(num_threads, 0);
+
+  // Each thread takes part in a different number of phases, and then leaves.
+  // The remaining threads must keep going without waiting for it.
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads);
+  for (int thread_index = 0; thread_index < num_threads; ++thread_index) {
+    threads.emplace_back([&, thread_index] {
+      const int num_steps = (thread_index + 1) * num_steps_per_thread;
+      for (int step = 1; step <= num_steps; ++step) {
+        values[thread_index] = step;
+        EXPECT_EQ(phaser.Wait(), 2u * step - 2);
+        // All threads still taking part are on the same step.
+        for (int i = thread_index; i < num_threads; ++i)
+          EXPECT_EQ(values[i], step);
+        EXPECT_EQ(phaser.Wait(), 2u * step - 1);
+      }
+      EXPECT_EQ(phaser.ArriveAndDeregister(), 2u * num_steps);
+    });
+  }
+
+  // Teardown.
+  for (auto& thread : threads) thread.join();
+}
+
+// =============================================================================
+TEST(PhaserTest, RegisteredParticipantHoldsCurrentPhase) {
+  // Setup.
+  Phaser phaser(/*num_participants=*/1);
+  std::atomic<bool> passed{false};
+
+  // A new participant joins the phase in progress.
+  EXPECT_EQ(phaser.Register(), 0u);
+  std::thread thread([&] {
+    EXPECT_EQ(phaser.Wait(), 0u);
+    passed.store(true);
+  });
+
+  // The phase cannot complete until the main thread arrives.
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_FALSE(passed.load());
+  EXPECT_EQ(phaser.Wait(), 0u);
+
+  // Teardown.
+  thread.join();
+  EXPECT_TRUE(passed.load());
+}
+
+// =============================================================================
+TEST(PhaserTest, ParticipantCountStaysInRange) {
+  // Setup.
+  Phaser phaser(/*num_participants=*/Phaser::kMaxParticipants - 1);
+
+  // The last participant that fits can still register.
+  EXPECT_EQ(phaser.Register(), 0u);
+
+  // Going past the limit, or below zero participants, is not silently wrapped.
+  EXPECT_DEATH(phaser.Register(), "");
+  Phaser empty_phaser;
+  EXPECT_DEATH(empty_phaser.ArriveAndDeregister(), "");
+}
+
+}  // namespace
+}  // namespace modcncy
@@ -0,0 +1,74 @@
+// Copyright 2022 The Modcncy Authors. All rights reserved.
+// Use of this source code is governed by the license found in the LICENSE file.
+// -----------------------------------------------------------------------------
+
+#include <gtest/gtest.h>
+#include <modcncy/reducing_barrier.h>
+
+#include <algorithm>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+namespace modcncy {
+namespace {
+
+// Reduction operation keeping the minimum value.
+struct Min {
+  int operator()(int a, int b) const { return std::min(a, b); }
+};  // struct Min
+
+// =============================================================================
+TEST(ReducingBarrierTest, SingleThread) {
+  ReducingBarrier<int> barrier(/*num_threads=*/1);
+  EXPECT_EQ(barrier.Wait(/*thread_id=*/0, /*value=*/42), 42);
+  EXPECT_EQ(barrier.Wait(/*thread_id=*/0, /*value=*/7), 7);
+}
+
+// =============================================================================
+TEST(ReducingBarrierTest, ReusableSumReduction) {
+  // Setup.
+  constexpr int num_threads = 16;
+  constexpr int num_steps = 1000;
+  ReducingBarrier<int> barrier(num_threads);
+
+  // At every step, all threads must receive the sum of all contributions.
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads);
+  for (int thread_index = 0; thread_index < num_threads; ++thread_index) {
+    threads.emplace_back([&, thread_index] {
+      for (int step = 1; step <= num_steps; ++step) {
+        EXPECT_EQ(barrier.Wait(thread_index, step * thread_index),
+                  step * num_threads * (num_threads - 1) / 2);
+      }
+    });
+  }
+
+  // Teardown.
+  for (auto& thread : threads) thread.join();
+}
+
+// =============================================================================
+TEST(ReducingBarrierTest, ReusableMinReduction) {
+  // Setup.
+  constexpr int num_threads = 13;
+  constexpr int num_steps = 1000;
+  ReducingBarrier<int, Min> barrier(num_threads);
+
+  // At every step, a different thread contributes the minimum value.
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads);
+  for (int thread_index = 0; thread_index < num_threads; ++thread_index) {
+    threads.emplace_back([&, thread_index] {
+      for (int step = 0; step < num_steps; ++step) {
+        const int value = (thread_index + step) % num_threads;
+        EXPECT_EQ(barrier.Wait(thread_index, value), 0);
+      }
+    });
+  }
+
+  // Teardown.
+  for (auto& thread : threads) thread.join();
+}
+
+}  // namespace
+}  // namespace modcncy
@@ -0,0 +1,145 @@
+// Copyright 2022 The Modcncy Authors. All rights reserved.
+// Use of this source code is governed by the license found in the LICENSE file.
+// -----------------------------------------------------------------------------
+
+#include <gtest/gtest.h>
+#include <modcncy/task.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace modcncy {
+namespace {
+
+// =============================================================================
+TEST(TaskTest, EmptyTask) {
+  Task<> default_task;
+  Task<> null_task = nullptr;
+  EXPECT_EQ(default_task, nullptr);
+  EXPECT_EQ(null_task, nullptr);
+  EXPECT_FALSE(default_task);
+}
+
+// =============================================================================
+TEST(TaskTest, RunsStoredCallable) {
+  int counter = 0;
+  Task<> task = [&counter] { ++counter; };
+  EXPECT_NE(task, nullptr);
+  task();
+  task();
+  EXPECT_EQ(counter, 2);
+}
+
+// =============================================================================
+TEST(TaskTest, MovesCallableWithNonTrivialCaptures) {
+  // Setup.
+  std::string result;
+  const std::string text(100, 'x');  // Too long for a small string buffer.
+  Task<> task = [&result, text] { result = text; };
+
+  // Moving a task moves its callable, and leaves the source empty.
+  Task<> moved_task = std::move(task);
+  EXPECT_EQ(task, nullptr);
+  Task<> assigned_task;
+  assigned_task = std::move(moved_task);
+  EXPECT_EQ(moved_task, nullptr);
+  assigned_task();
+  EXPECT_EQ(result, text);
+}
+
+// =============================================================================
+TEST(TaskTest, DestroysCallableOnlyOnce) {
+  // Setup.
+  auto captured = std::make_shared<int>(42);
+  EXPECT_EQ(captured.use_count(), 1);
+
+  // Captures are released when the task is reset or destroyed, and never twice
+  // after being moved around.
+  {
+    Task<> task = [captured] {};
+    EXPECT_EQ(captured.use_count(), 2);
+    Task<> moved_task = std::move(task);
+    EXPECT_EQ(captured.use_count(), 2);
+    moved_task = nullptr;
+    EXPECT_EQ(captured.use_count(), 1);
+    Task<> other_task = [captured] {};
+    EXPECT_EQ(captured.use_count(), 2);
+  }
+  EXPECT_EQ(captured.use_count(), 1);
+}
+
+// =============================================================================
+TEST(TaskTest, HoldsCallablesUpToItsCapacity) {
+  // Eight pointer-sized captures fill a default task.
+  size_t sum = 0;
+  const size_t a = 1, b = 2, c = 3, d = 4, e = 5, f = 6, g = 7;
+  Task<> task = [&sum, a, b, c, d, e, f, g] {
+    sum = a + b + c + d + e + f + g;
+  };
+  task();
+  EXPECT_EQ(sum, 28u);
+  // Larger callables need a larger task.
+  const size_t h = 8;
+  Task<128> large_task = [&sum, a, b, c, d, e, f, g, h] {
+    sum = a + b + c + d + e + f + g + h;
+  };
+  large_task();
+  EXPECT_EQ(sum, 36u);
+}
+
+// =============================================================================
+TEST(TaskTest, RunsCallableTakingWorkerContext) {
+  // Setup.
+  WorkerContext context(/*thread_index=*/3);
+  int thread_index = -1;
+  Task<> task = [&thread_index](WorkerContext& context) {
+    thread_index = context.thread_index();
+  };
+
+  // The task gets the context it runs with, or one of its own without it.
+  task(context);
+  EXPECT_EQ(thread_index, 3);
+  task();
+  EXPECT_EQ(thread_index, 0);
+
+  // Tasks taking no arguments ignore the context.
+  int counter = 0;
+  Task<> other_task = [&counter] { ++counter; };
+  other_task(context);
+  EXPECT_EQ(counter, 1);
+}
+
+// =============================================================================
+TEST(WorkerContextTest, ReusesScratchBuffer) {
+  WorkerContext context;
+  // The buffer is reused while large enough, and only grows otherwise.
+  int* buffer = context.Scratch<int>(100);
+  for (int i = 0; i < 100; ++i) buffer[i] = i;
+  EXPECT_EQ(context.Scratch<int>(50), buffer);
+  EXPECT_EQ(static_cast<void*>(context.Scratch<char>(400)),
+            static_cast<void*>(buffer));
+  double* larger_buffer = context.Scratch<double>(1000);
+  for (int i = 0; i < 1000; ++i) larger_buffer[i] = i;
+  EXPECT_EQ(context.Scratch<double>(1000)[999], 999);
+}
+
+// =============================================================================
+TEST(WorkerContextTest, KeepsScratchObjectsOfEveryType) {
+  WorkerContext context;
+  // Objects that are not trivial are constructed, so they can be assigned.
+  std::string* strings = context.Scratch<std::string>(10);
+  for (int i = 0; i < 10; ++i) strings[i] = std::string(100, 'a' + i);
+  EXPECT_EQ(strings[9], std::string(100, 'j'));
+
+  // Every type has a buffer of its own, reused while large enough.
+  std::vector<int>* vectors = context.Scratch<std::vector<int>>(10);
+  EXPECT_NE(static_cast<void*>(vectors), static_cast<void*>(strings));
+  EXPECT_EQ(context.Scratch<std::string>(5), strings);
+  strings = context.Scratch<std::string>(1000);
+  for (int i = 0; i < 1000; ++i) strings[i] = std::string(100, 'a');
+}
+
+}  // namespace
+}  // namespace modcncy
@@ -0,0 +1,83 @@
+// Copyright 2022 The Modcncy Authors. All rights reserved.
+// Use of this source code is governed by the license found in the LICENSE file.
+// -----------------------------------------------------------------------------
+
+#include <gtest/gtest.h>
+#include <modcncy/templated_barrier.h>
+#include <modcncy/wait_policy.h>
+
+#include <functional>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+namespace modcncy {
+namespace {
+
+template <typename BarrierT>
+class TemplatedBarrierTest : public testing::Test {};
+
+typedef std::function<void()> Completion;
+
+typedef testing::Types<CentralSenseCounterBarrierT<YieldWaitPolicy, Completion>,
+                       CentralStepCounterBarrierT<YieldWaitPolicy, Completion>>
+    AllTemplatedBarriers;
+
+TYPED_TEST_SUITE(TemplatedBarrierTest, AllTemplatedBarriers);
+
+// =============================================================================
+TYPED_TEST(TemplatedBarrierTest, ReusableBarrier) {
+  // Setup.
+  TypeParam barrier(/*completion=*/[] {});
+  constexpr int num_threads = 16;
+  constexpr int num_steps = 1000;
+  std::vector<int> values(num_threads, 0);
+
+  // At every step, each thread publishes its value and reads the value of its
+  // neighbor. A second barrier makes sure that nobody overwrites a value that
+  // is still being read.
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads);
+  for (int thread_index = 0; thread_index < num_threads; ++thread_index) {
+    threads.emplace_back([&, thread_index] {
+      const int neighbor_index = (thread_index + 1) % num_threads;
+      for (int step = 1; step <= num_steps; ++step) {
+        values[thread_index] = step;
+        barrier.Wait(num_threads);
+        EXPECT_EQ(values[neighbor_index], step);
+        barrier.Wait(barrier.Arrive(num_threads));
+      }
+    });
+  }
+
+  // Teardown.
+  for (auto& thread : threads) thread.join();
+}
+
+// =============================================================================
+TYPED_TEST(TemplatedBarrierTest, CompletionRunsOncePerBarrierSynchronization) {
+  // Setup.
+  constexpr int num_threads = 16;
+  constexpr int num_steps = 1000;
+  int completed_steps = 0;
+  TypeParam barrier(/*completion=*/[&] { ++completed_steps; });
+
+  // Once released, every thread must observe the completion of the step.
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads);
+  for (int thread_index = 0; thread_index < num_threads; ++thread_index) {
+    threads.emplace_back([&] {
+      for (int step = 1; step <= num_steps; ++step) {
+        barrier.Wait(num_threads);
+        EXPECT_EQ(completed_steps, 2 * step - 1);
+        barrier.Wait(num_threads);
+      }
+    });
+  }
+
+  // Teardown.
+  for (auto& thread : threads) thread.join();
+  EXPECT_EQ(completed_steps, 2 * num_steps);
+}
+
+}  // namespace
+}  // namespace modcncy
@@ -0,0 +1,413 @@
+// Copyright 2022 The Modcncy Authors. All rights reserved.
+// Use of this source code is governed by the license found in the LICENSE file.
+// -----------------------------------------------------------------------------
+
+#include <gtest/gtest.h>
+#include <modcncy/barrier.h>
+#include <modcncy/templated_barrier.h>
+#include <modcncy/wait_policy.h>
+
+#include <atomic>
+#include <chrono>  // NOLINT(build/c++11)
+#include <functional>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+namespace modcncy {
+namespace {
+
+// =============================================================================
+TEST(ExponentialBackoffWaitPolicyTest, DoublesPausesUpToMaxPauses) {
+  // Setup.
+  ExponentialBackoffWaitPolicy policy(/*min_pauses=*/1, /*max_pauses=*/16);
+
+  // Pauses double on every iteration until capped.
+  for (int num_pauses : {1, 2, 4, 8, 16, 16, 16}) {
+    EXPECT_EQ(policy.NumPauses(), num_pauses);
+    policy();
+  }
+
+  // Teardown.
+  policy.Reset();
+  EXPECT_EQ(policy.NumPauses(), 1);
+}
+
+// =============================================================================
+TEST(ExponentialBackoffWaitPolicyTest, ResetsThroughStdFunction) {
+  // Setup.
+  std::function<void()> policy =
+      ExponentialBackoffWaitPolicy(/*min_pauses=*/2, /*max_pauses=*/16);
+  std::function<void()> other_policy = &cpu_pause;
+  for (int i = 0; i < 3; ++i) policy();
+
+  // Stateful policies start over in place, and others are left as they are.
+  ResetWaitPolicy(&policy);
+  ResetWaitPolicy(&other_policy);
+  EXPECT_EQ(policy.target<ExponentialBackoffWaitPolicy>()->NumPauses(), 2);
+  EXPECT_NE(other_policy, nullptr);
+}
+
+// =============================================================================
+TEST(ExponentialBackoffWaitPolicyTest, YieldsPastThreshold) {
+  // Setup.
+  ExponentialBackoffWaitPolicy policy(/*min_pauses=*/2, /*max_pauses=*/8,
+                                      /*yield_threshold=*/3);
+
+  // Pauses for the first iterations, and then yields.
+  for (int num_pauses : {2, 4, 8, 0, 0}) {
+    EXPECT_EQ(policy.NumPauses(), num_pauses);
+    policy();
+  }
+}
+
+// =============================================================================
+TEST(ExponentialBackoffWaitPolicyTest, PlugsIntoBarriers) {
+  // Setup.
+  constexpr int num_threads = 4;
+  constexpr int num_steps = 1000;
+  Barrier* barrier = Barrier::Create(BarrierType::kCentralSenseCounterBarrier);
+  CentralStepCounterBarrierT<ExponentialBackoffWaitPolicy> templated_barrier;
+  std::vector<int> values(num_threads, 0);
+
+  // Every wait starts over with a fresh copy of the policy. Yielding past a
+  // few iterations keeps the test fast even with fewer cores than threads.
+  const ExponentialBackoffWaitPolicy policy(/*min_pauses=*/1,
+                                            /*max_pauses=*/64,
+                                            /*yield_threshold=*/8);
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads);
+  for (int thread_index = 0; thread_index < num_threads; ++thread_index) {
+    threads.emplace_back([&, thread_index] {
+      const int neighbor_index = (thread_index + 1) % num_threads;
+      for (int step = 1; step <= num_steps; ++step) {
+        values[thread_index] = step;
+        barrier->Wait(num_threads, policy);
+        EXPECT_EQ(values[neighbor_index], step);
+        templated_barrier.Wait(num_threads, policy);
+      }
+    });
+  }
+
+  // Teardown.
+  for (auto& thread : threads) thread.join();
+  delete barrier;
+}
+
+// =============================================================================
+TEST(CalibratedPauseWaitPolicyTest, ScalesPausesWithTargetDuration) {
+  // The latency is measured once.
+  const double latency_ns = cpu_pause_latency_ns();
+  EXPECT_GT(latency_ns, 0.0);
+  EXPECT_EQ(cpu_pause_latency_ns(), latency_ns);
+
+  // Longer iterations pause more times, and every iteration pauses.
+  const CalibratedPauseWaitPolicy short_policy(/*pause_ns=*/0);
+  const CalibratedPauseWaitPolicy long_policy(/*pause_ns=*/100000);
+  EXPECT_EQ(short_policy.NumPauses(), 1);
+  EXPECT_GE(long_policy.NumPauses(), static_cast<int>(100000 / latency_ns));
+  EXPECT_LE(long_policy.NumPauses(), static_cast<int>(100000 / latency_ns) + 1);
+}
+
+// =============================================================================
+TEST(CalibratedPauseWaitPolicyTest, PlugsIntoBarriers) {
+  // Setup.
+  constexpr int num_threads = 2;
+  constexpr int num_steps = 20;
+  Barrier* barrier = Barrier::Create(BarrierType::kCentralSenseCounterBarrier);
+  CentralStepCounterBarrierT<CalibratedPauseWaitPolicy> templated_barrier;
+  const CalibratedPauseWaitPolicy policy;
+
+  // Pausing threads give up the CPU only when preempted, so few threads and
+  // steps keep the test fast.
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads);
+  for (int thread_index = 0; thread_index < num_threads; ++thread_index) {
+    threads.emplace_back([&] {
+      for (int step = 0; step < num_steps; ++step) {
+        barrier->Wait(num_threads, policy);
+        templated_barrier.Wait(num_threads);
+      }
+    });
+  }
+
+  // Teardown.
+  for (auto& thread : threads) thread.join();
+  delete barrier;
+}
+
+// =============================================================================
+TEST(EventCountTest, NotifyAllWakesUpParkedThreads) {
+  // Setup.
+  constexpr int num_threads = 4;
+  EventCount event_count;
+  std::atomic<bool> ready{false};
+
+  // Threads park until the condition holds, re-reading the epoch before every
+  // check of the condition.
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads);
+  for (int thread_index = 0; thread_index < num_threads; ++thread_index) {
+    threads.emplace_back([&] {
+      for (;;) {
+        const unsigned epoch = event_count.Epoch();
+        if (ready.load()) break;
+        event_count.Wait(epoch);
+      }
+    });
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  ready.store(true);
+  event_count.NotifyAll();
+
+  // Teardown.
+  for (auto& thread : threads) thread.join();
+  EXPECT_EQ(event_count.Epoch(), 1u);
+
+  // A stale epoch does not park at all.
+  event_count.Wait(0);
+}
+
+// =============================================================================
+TEST(SpinYieldParkWaitPolicyTest, PlugsIntoBarriers) {
+  // Setup.
+  constexpr int num_threads = 4;
+  constexpr int num_steps = 200;
+  EventCount event_count;
+  auto notify = [&] { event_count.NotifyAll(); };
+  CentralStepCounterBarrierT<SpinYieldParkWaitPolicy, NoCompletion,
+                             std::function<void()>>
+      templated_barrier(NoCompletion(), notify);
+
+  // Threads park almost right away, so only notifications wake them up.
+  const SpinYieldParkWaitPolicy policy(&event_count, /*num_spins=*/4,
+                                       /*num_yields=*/1);
+  for (BarrierType type : {BarrierType::kCentralSenseCounterBarrier,
+                           BarrierType::kCentralStepCounterBarrier,
+                           BarrierType::kCombiningTreeBarrier,
+                           BarrierType::kDisseminationBarrier,
+                           BarrierType::kTournamentBarrier,
+                           BarrierType::kStaticTreeBarrier,
+                           BarrierType::kSpinThenParkBarrier,
+                           BarrierType::kAdaptive,
+                           BarrierType::kNumaHierarchicalBarrier}) {
+    Barrier* barrier = Barrier::Create(type, num_threads);
+    barrier->SetEventCount(&event_count);
+    std::vector<int> values(num_threads, 0);
+    std::vector<std::thread> threads;
+    threads.reserve(num_threads);
+    for (int thread_index = 0; thread_index < num_threads; ++thread_index) {
+      threads.emplace_back([&, thread_index] {
+        const int neighbor_index = (thread_index + 1) % num_threads;
+        for (int step = 1; step <= num_steps; ++step) {
+          values[thread_index] = step;
+          barrier->Wait(num_threads, thread_index, policy);
+          EXPECT_EQ(values[neighbor_index], step);
+          templated_barrier.Wait(num_threads, policy);
+        }
+      });
+    }
+    for (auto& thread : threads) thread.join();
+    delete barrier;
+  }
+}
+
+// =============================================================================
+TEST(SpinYieldParkWaitPolicyTest, KeepsYieldingWithoutEventCount) {
+  // Setup.
+  constexpr int num_threads = 4;
+  constexpr int num_steps = 100;
+  Barrier* barrier = Barrier::Create(BarrierType::kCentralStepCounterBarrier);
+
+  // Nothing is notified, so the policy must never park.
+  const SpinYieldParkWaitPolicy policy(/*event_count=*/nullptr,
+                                       /*num_spins=*/1, /*num_yields=*/1);
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads);
+  for (int thread_index = 0; thread_index < num_threads; ++thread_index) {
+    threads.emplace_back([&] {
+      for (int step = 0; step < num_steps; ++step)
+        barrier->Wait(num_threads, policy);
+    });
+  }
+
+  // Teardown.
+  for (auto& thread : threads) thread.join();
+  delete barrier;
+}
+
+// =============================================================================
+TEST(AdaptiveWaitPolicyTest, SpinsOnlyForShortExpectedWaits) {
+  // Setup.
+  WaitEstimate estimate;
+  const AdaptiveWaitPolicy policy(&estimate, /*event_count=*/nullptr,
+                                  /*max_spin_ns=*/100000);
+
+  // Without history, every wait is expected to end right away.
+  EXPECT_EQ(estimate.ExpectedNs(), 0);
+  EXPECT_EQ(policy.SpinNs(), AdaptiveWaitPolicy::kMinSpinNs);
+
+  // Short waits spin for twice their expected duration.
+  for (int i = 0; i < 200; ++i) estimate.Record(10000);
+  EXPECT_GT(estimate.ExpectedNs(), 10000 - WaitEstimate::kSampleWeight);
+  EXPECT_LE(estimate.ExpectedNs(), 10000);
+  EXPECT_EQ(policy.SpinNs(),
+            2 * estimate.ExpectedNs() + AdaptiveWaitPolicy::kMinSpinNs);
+
+  // Long waits barely spin before parking.
+  for (int i = 0; i < 200; ++i) estimate.Record(1000000);
+  EXPECT_GT(estimate.ExpectedNs(), 100000);
+  EXPECT_EQ(policy.SpinNs(), AdaptiveWaitPolicy::kMinSpinNs);
+}
+
+// =============================================================================
+TEST(AdaptiveWaitPolicyTest, RecordsOnlyWaitsThatIterated) {
+  // Setup.
+  WaitEstimate estimate;
+  constexpr int64_t wait_ns = 2 * 1000 * 1000;
+
+  // Neither unused policies nor copies of a waiting one record a wait.
+  {
+    AdaptiveWaitPolicy policy(&estimate);
+    policy();
+    { AdaptiveWaitPolicy unused_policy(&estimate); }
+    { AdaptiveWaitPolicy copied_policy(policy); }
+    EXPECT_EQ(estimate.ExpectedNs(), 0);
+    std::this_thread::sleep_for(std::chrono::nanoseconds(wait_ns));
+  }
+
+  // The waiting policy records its wait when destroyed.
+  EXPECT_GE(estimate.ExpectedNs(), wait_ns / WaitEstimate::kSampleWeight);
+}
+
+// =============================================================================
+TEST(AdaptiveWaitPolicyTest, ResetRecordsWaitAndStartsOver) {
+  // Setup.
+  WaitEstimate estimate;
+  constexpr int64_t wait_ns = 2 * 1000 * 1000;
+  std::function<void()> policy = AdaptiveWaitPolicy(&estimate);
+
+  // Resetting a policy that did not iterate records nothing.
+  ResetWaitPolicy(&policy);
+  EXPECT_EQ(estimate.ExpectedNs(), 0);
+
+  // Resetting a waiting policy records its wait, only once.
+  policy();
+  std::this_thread::sleep_for(std::chrono::nanoseconds(wait_ns));
+  ResetWaitPolicy(&policy);
+  const int64_t expected_ns = estimate.ExpectedNs();
+  EXPECT_GE(expected_ns, wait_ns / WaitEstimate::kSampleWeight);
+  ResetWaitPolicy(&policy);
+  policy = nullptr;
+  EXPECT_EQ(estimate.ExpectedNs(), expected_ns);
+}
+
+// =============================================================================
+TEST(AdaptiveWaitPolicyTest, PlugsIntoBarriers) {
+  // Setup.
+  constexpr int num_threads = 4;
+  constexpr int num_steps = 200;
+  EventCount event_count;
+  auto notify = [&] { event_count.NotifyAll(); };
+  CentralStepCounterBarrierT<AdaptiveWaitPolicy, NoCompletion,
+                             std::function<void()>>
+      templated_barrier(NoCompletion(), notify);
+
+  // Every barrier instance learns its own waits, and threads expecting long
+  // waits park until notified.
+  for (BarrierType type : {BarrierType::kCentralSenseCounterBarrier,
+                           BarrierType::kCentralStepCounterBarrier,
+                           BarrierType::kCombiningTreeBarrier,
+                           BarrierType::kDisseminationBarrier,
+                           BarrierType::kTournamentBarrier,
+                           BarrierType::kStaticTreeBarrier,
+                           BarrierType::kSpinThenParkBarrier,
+                           BarrierType::kAdaptive,
+                           BarrierType::kNumaHierarchicalBarrier}) {
+    Barrier* barrier = Barrier::Create(type, num_threads);
+    barrier->SetEventCount(&event_count);
+    WaitEstimate estimate;
+    WaitEstimate templated_estimate;
+    const AdaptiveWaitPolicy policy(&estimate, &event_count);
+    const AdaptiveWaitPolicy templated_policy(&templated_estimate,
+                                              &event_count);
+    std::vector<int> values(num_threads, 0);
+    std::vector<std::thread> threads;
+    threads.reserve(num_threads);
+    for (int thread_index = 0; thread_index < num_threads; ++thread_index) {
+      threads.emplace_back([&, thread_index] {
+        const int neighbor_index = (thread_index + 1) % num_threads;
+        for (int step = 1; step <= num_steps; ++step) {
+          values[thread_index] = step;
+          barrier->Wait(num_threads, thread_index, policy);
+          EXPECT_EQ(values[neighbor_index], step);
+          templated_barrier.Wait(num_threads, templated_policy);
+        }
+      });
+    }
+    for (auto& thread : threads) thread.join();
+    EXPECT_GT(estimate.ExpectedNs(), 0);
+    EXPECT_GT(templated_estimate.ExpectedNs(), 0);
+    delete barrier;
+  }
+}
+
+// =============================================================================
+TEST(MonitorWaitPolicyTest, WatchesAddressThroughStdFunction) {
+  // Setup.
+  std::atomic<unsigned> flag{0};
+  std::function<void()> policy = MonitorWaitPolicy();
+  std::function<void()> other_policy = &cpu_pause;
+
+  // Only address-aware policies are pointed to the flag.
+  WatchAddress(&policy, &flag);
+  WatchAddress(&other_policy, &flag);
+  EXPECT_EQ(policy.target<MonitorWaitPolicy>()->Address(), &flag);
+
+  // Sleeps are bounded even if the flag never changes.
+  for (int i = 0; i < 100; ++i) policy();
+  MonitorWaitPolicy unwatched_policy;
+  for (int i = 0; i < 100; ++i) unwatched_policy();
+}
+
+// =============================================================================
+TEST(MonitorWaitPolicyTest, PlugsIntoBarriers) {
+  // Setup.
+  constexpr int num_threads = 2;
+  constexpr int num_steps = 20;
+  CentralSenseCounterBarrierT<MonitorWaitPolicy> templated_barrier;
+  const MonitorWaitPolicy policy;
+
+  // Waiting threads wake up on writes to the watched flags of every barrier,
+  // or pause where WAITPKG is not supported. Pausing threads give up the CPU
+  // only when preempted, so few threads and steps keep the test fast.
+  for (BarrierType type : {BarrierType::kCentralSenseCounterBarrier,
+                           BarrierType::kCentralStepCounterBarrier,
+                           BarrierType::kCombiningTreeBarrier,
+                           BarrierType::kDisseminationBarrier,
+                           BarrierType::kTournamentBarrier,
+                           BarrierType::kStaticTreeBarrier,
+                           BarrierType::kSpinThenParkBarrier,
+                           BarrierType::kAdaptive,
+                           BarrierType::kNumaHierarchicalBarrier}) {
+    Barrier* barrier = Barrier::Create(type, num_threads);
+    std::vector<int> values(num_threads, 0);
+    std::vector<std::thread> threads;
+    threads.reserve(num_threads);
+    for (int thread_index = 0; thread_index < num_threads; ++thread_index) {
+      threads.emplace_back([&, thread_index] {
+        const int neighbor_index = (thread_index + 1) % num_threads;
+        for (int step = 1; step <= num_steps; ++step) {
+          values[thread_index] = step;
+          barrier->Wait(num_threads, thread_index, policy);
+          EXPECT_EQ(values[neighbor_index], step);
+          templated_barrier.Wait(num_threads, policy);
+        }
+      });
+    }
+    for (auto& thread : threads) thread.join();
+    delete barrier;
+  }
+}
+
+}  // namespace
+}  // namespace modcncy